@@ -18,21 +18,55 @@ This file contains control flags and information that should be accessed from ev
 #define BENCHMARKING TRUE              ///<defines if we do benchmark testing
 #define WITH_HEADPHONES FALSE         ///< defines whether to use headphones or not
 
+//numeric precision of the frame path (conversion, windowing, fft, spectrum, bandpass and peak picking)
+//single precision is the default, build with 'make PRECISION=double' to use double precision
+#ifdef SINGLE_PRECISION
+typedef float sample_t;                 ///< type of the samples and spectra in the frame path
+#define SAMPLE_SQRT sqrtf               ///< square root in the precision of sample_t
+#define SAMPLE_LOG10 log10f             ///< decimal logarithm in the precision of sample_t
+#else
+typedef double sample_t;                ///< type of the samples and spectra in the frame path
+#define SAMPLE_SQRT sqrt                ///< square root in the precision of sample_t
+#define SAMPLE_LOG10 log10              ///< decimal logarithm in the precision of sample_t
+#endif
+
 //audio interface configuration
 #define SAMPLE_SIZE 4096        ///< defines the sample size to be captured before running fft over it
 #define SAMPLE_RATE 44100       ///< defines the sample rate that the microphone captures data
 #define BUFFER_SIZE 128         ///< defines the buffer size for the real time audio capture
 #define NUM_CHANNELS 2          ///< defines the number of channels of the microphone
 #define SOUND_CARD_NUMBER 0     ///< defines the sound card number\n command: cat /proc/asound/cards
+#define AUDIO_RING_BUFFER_TIME 2000.0  ///< milliseconds of audio the ring between the capture and the processing thread holds at least
+#define CACHE_LINE_SIZE 64            ///< size of a cache line in bytes, data written by different threads is kept on separate lines
+#define BACKPRESSURE_POLICY "block"    ///< what the threaded version does when the processing falls behind the capture\n options: block, drop-oldest, degrade
+#define AUDIO_LAG_DEADLINE 4.0         ///< hop durations a period may wait for its processing after it was read before degrade skips hops
+#define PIN_PIPELINE_THREADS TRUE      ///< pins the capture, spectral analysis and note tracking threads of the threaded version to the cores 0, 1 and 2
 
 //audio preprocessing
 #define WINDOWING_FUNCTION "Rectangle"  ///< name for fitting function
+#define KAISER_BETA 9.42477796076938      ///< shape parameter of the kaiser window, pi*alpha with alpha = 3\n larger values lower the side lobes and widen the main lobe
 #define LOW_FREQUENCY 100.0               ///< lowest frequency for bandpassing
 #define HIGH_FREQUENCY 10000.0            ///< highest frequency for bandpassing
+#define FFT_ENGINE "builtin"              ///< fft engine that transforms the frames\n options: builtin, fftw
+#define FFTW_WISDOM_FILE "../output/fftwf.wisdom" ///< file that stores the measured fftw plans between runs
+#define SPECTRAL_ANALYZER "fft"           ///< analyzer that computes the spectrum of the frames in the note, chord and melody modes\n options: fft, goertzel, sliding-dft, constant-q
+#define NOTE_BANK_NEIGHBOURS 0            ///< number of bins on each side of a note bin that the goertzel and sliding-dft analyzers also evaluate
+#define CONSTANT_Q_BINS_PER_OCTAVE 12      ///< bins per octave of the constant-q analyzer\n options: 12 (semitones), 36 (third-tones)
+#define FRAME_ANALYSIS_WORKERS 0          ///< number of threads that analyze the frames of the threaded and the post processing version in parallel, 0 for one per online core that is not taken by a pinned pipeline thread
+#define FRAME_ANALYSIS_QUEUE_SIZE 4       ///< number of frames queued for every frame analysis thread
+#define PEAK_INTERPOLATION 1              ///< 1 to estimate the frequency of the fft peak between the bins by parabolic interpolation, 0 to use the bin
 
 //audio transcription configuration
 #define TUNING_PITCH 440.0                ///< the reference pitch a4
 #define PITCH_RESOLUTION 40.0             ///< pitch difference in cents to be allowed to be seen as the same note
+#define NOTE_LOWEST_FREQUENCY 100.0       ///< lowest frequency that is transcribed to a note
+#define NOTE_HIGHEST_FREQUENCY 5000.0     ///< highest frequency that is transcribed to a note
+#define NO_MIDI_NOTE (-1)                 ///< midi note number of a frequency that is no note, e.g. between two notes or out of range
+#define NOTE_ONSET_TIME 40.0              ///< milliseconds a new note has to be detected before it replaces the current note
+#define NOTE_OFFSET_TIME 80.0             ///< milliseconds no note has to be detected before the current note ends
+#define NUM_NOTE_BINS 72                  ///< notes searched for chords, six octaves starting at c with 32.7Hz for a tuning pitch of 440Hz
+#define NOTE_BINS_FIRST_MIDI_NOTE 24      ///< midi note of the first note searched for chords, the c with 32.7Hz
+#define HARMONIC_SUPPRESSION_FACTOR 0.5   ///< a note at a harmonic of a louder note is dropped if its power is below this fraction of the power of the louder note
 #define LOUDNESS_THRESHOLD_FACTOR 0.99  ///< for chord detection, loudness difference logarithmically
 #define RHYTHM_RESOLUTION 16            ///< the resolution that should be taken for the smallest distinguishable note length
 
@@ -9,6 +9,9 @@
 #ifndef AUDIOPREPROCESSING_H_INCLUDED
 #define AUDIOPREPROCESSING_H_INCLUDED
 
+#include "ApplicationMacros.h"
+#include "Structures.h"
+
 /**
 @brief This function calculates the faculty.
 @param x the number for which the faculty should be built
@@ -18,12 +21,44 @@ int faculty(int x);
 
 /**
 @brief This function translates fft data into an array containing amplitude values for each bin.
-@param amps The array in which the different amplitudes for the bins will be stored.
+Only the sampleSize/2+1 non-redundant bins of the real fft are used.
+@param amps The array in which the different amplitudes for the bins will be stored, needs space for sampleSize/2+1 values.
 @param real The real part of the fft data.
 @param imag The imaginary part of the fft data.
-@param sampleSize The size of the amps array.
+@param sampleSize The sample size of the fft.
+**/
+void getFrequencySpectrum(sample_t *amps, sample_t *real, sample_t *imag, int sampleSize);
+
+/**
+@brief This function calculates the power, i.e. the squared magnitude, of the fft data in the bins of a band.
+The power orders the bins in the same way as the logarithmic amplitudes of getFrequencySpectrum, the bins outside of the band are not touched.
+@param power the array in which the power of the bins minBin..maxBin-1 will be stored
+@param real the real part of the fft data
+@param imag the imaginary part of the fft data
+@param minBin first bin of the band
+@param maxBin bin after the last bin of the band, at most sampleSize/2+1
+**/
+void getPowerSpectrum(sample_t *restrict power, const sample_t *restrict real, const sample_t *restrict imag, int minBin, int maxBin);
+
+/**
+@brief This function converts the power of bins to the logarithmic scale of getFrequencySpectrum, 10*log10 of the magnitude.
+The logarithm is approximated with an error below 0.0001, it is meant for output like the spectrogram, decisions use the power.
+@param amps the array in which the logarithmic amplitudes will be stored, may be the power array itself
+@param power the power of the bins as calculated by getPowerSpectrum
+@param numBins the number of bins to convert
+**/
+void getLogarithmicSpectrum(sample_t *amps, const sample_t *power, int numBins);
+
+/**
+@brief This function calculates the bins of a frequency band as used by applyFrequencyBandpass.
+@param minBin receives the first bin of the band
+@param maxBin receives the bin after the last bin of the band, at most sampleSize/2+1
+@param sampleSize the sample size of the fft
+@param sampleRate how many samples are taken in one second
+@param lowFrequency lowest frequency to accept in analysis
+@param highFrequency highest frequency to accept in analysis
 **/
-void getFrequencySpectrum(double *amps, double *real, double *imag, int sampleSize);
+void getBandpassBins(int *minBin, int *maxBin, int sampleSize, double sampleRate, double lowFrequency, double highFrequency);
 
 /**
 @brief This functions calculates the gaussian number.
@@ -52,7 +87,8 @@ double getPositivePlankNumber(double epsilon, double n, int N);
 double getNegativePlankNumber(double epsilon, double n, int N);
 
 /**
-@brief This function calculates the specific order bessel function of first kind.
+@brief This function calculates the modified bessel function of first kind of a specific order.
+The power series is summed until the terms no longer change the sum, which takes about x/2+20 terms.
 @param order the specific order of the bessel function, in this application the order = 0
 @param x input for the bessel function
 @return besselNumber the calculated number is a result of a bessel function of first kind of specific order
@@ -87,30 +123,163 @@ double getDolphChebyshevNumber(double alpha, double beta, double n, int N, int k
 **/
 double gegenBauerPolynomial(int n,double alpha,double x);
 
+/**
+@brief This function resolves the name of a windowing function.
+@param windowingFunctionName the name of the window, e.g. hann
+@return windowingFunction the window, WINDOW_RECTANGLE for an unknown name
+**/
+WindowingFunction getWindowingFunction(char *windowingFunctionName);
+
+/**
+@brief This function returns the cached coefficients of a window for a frame size and calculates them on first use.
+The kaiser windows are cached per beta as well.
+@param windowingFunction the window
+@param sampleSize the sample size of the fft
+@param kaiserBeta the shape parameter of the kaiser window, 0 is the rectangle window and larger values trade a wider main lobe for lower side lobes\n ignored by the other windows
+@return coefficients the sampleSize coefficients of the window, valid until freeWindowCoefficients is called
+**/
+const sample_t *getWindowCoefficients(WindowingFunction windowingFunction, int sampleSize, double kaiserBeta);
+
+/**
+@brief This function frees the coefficients of all cached windows.
+**/
+void freeWindowCoefficients(void);
+
+/**
+@brief This function multiplies a frame with the coefficients of a window.
+@param audioData the actual array whose entries represent the audio data
+@param coefficients the coefficients returned by getWindowCoefficients for the same sample size
+@param sampleSize the sample size of the fft
+**/
+void applyWindowCoefficients(sample_t *restrict audioData, const sample_t *restrict coefficients, int sampleSize);
+
+/**
+@brief This function prepares the history of a frame loop, the frames start with silence.
+@param stager the stager to initialize
+@param sampleSize the size of the frames
+@param stepSize the number of new samples per hop
+@param windowingFunction the window that is applied to the staged frames
+@param kaiserBeta the shape parameter of the window if it is the kaiser window
+**/
+void initFrameStager(FrameStager *stager, int sampleSize, int stepSize, WindowingFunction windowingFunction, double kaiserBeta);
+
+/**
+@brief This function adds the samples of one hop to the history and stages the windowed frame for the fft.
+The 16 bit samples are converted to the range -1..1, windowed and written to the frame in a single pass, the history
+is read once and the new samples are not read back from it. Nothing is allocated.
+@param stager the stager of the frame loop
+@param samples the stepSize new samples
+@param frame the input of the fft, receives the sampleSize windowed samples, NULL if only the history is needed
+@return history the unwindowed frame of sampleSize samples with the new samples at the end, valid until the next call
+**/
+const sample_t *stageFrame(FrameStager *stager, const short *restrict samples, sample_t *restrict frame);
+
+/**
+@brief This function clears the history of a frame loop.
+@param stager the stager
+**/
+void resetFrameStager(FrameStager *stager);
+
+/**
+@brief This function frees memory space taken by the history of a frame loop.
+@param stager the stager
+**/
+void freeFrameStager(FrameStager *stager);
+
 /**
 @brief This function applies windowing on a specified audio data array.
+The kaiser window has the beta KAISER_BETA.
 @param audioData the actual array whose entries represent the audio data
 @param sampleSize the sample size of the fft
 @param windowingFunctionName is used to select between different windowing functions
 **/
-void applyWindowingFunction(double *audioData, int sampleSize,char *windowingFunctionName);
+void applyWindowingFunction(sample_t *audioData, int sampleSize,char *windowingFunctionName);
 
 /**
 @brief This function applies a certain frequency bandpass.
-@param amps the array containing the audio data
+@param amps the array containing the power of the sampleSize/2+1 bins of the spectrum
 @param sampleSize the sample size of the fft
 @param sampleRate how many samples are taken in one second
 @param lowFrequency lowest frequency to accept in analysis
 @param highFrequency highest frequency to accept in analysis
 **/
-void applyFrequencyBandpass(double *amps, int sampleSize, int sampleRate, double lowFrequency, double highFrequency);
+void applyFrequencyBandpass(sample_t *amps, int sampleSize, int sampleRate, double lowFrequency, double highFrequency);
 
 /**
 @brief This function gets the frequency bin with the maximum amplitude.
-@param amps the array containing the audio data
+Only bins louder than a magnitude of 1 are considered, 0 is returned for a quieter frame.
+@param amps the array containing the power of the sampleSize/2+1 bins of the spectrum
 @param sampleSize the sample size of the fft
 @return frequencyBin the calculated frequencyBin whose entry contains the maximal amplitude compared to all other bins in the array
 **/
-int getFrequencyBin(double *amps, int sampleSize);
+int getFrequencyBin(sample_t *amps, int sampleSize);
+
+/**
+@brief This function finds the loudest bin of a band directly in the fft data.
+It replaces getPowerSpectrum, applyFrequencyBandpass and getFrequencyBin with a single vectorized pass over the band that calculates
+the power and keeps the maximum of every vector lane, no amplitude array is written. The result equals that of the three functions.
+@param peak receives the loudest bin, its power and the power of its neighbours
+@param real the real part of the fft data
+@param imag the imaginary part of the fft data
+@param minBin first bin of the band, as calculated by getBandpassBins
+@param maxBin bin after the last bin of the band, at most sampleSize/2+1
+@param sampleSize the sample size of the fft
+**/
+void findSpectralPeak(SpectralPeak *peak, const sample_t *restrict real, const sample_t *restrict imag, int minBin, int maxBin, int sampleSize);
+
+/**
+@brief This function estimates the fractional bin of the frequency of a spectral peak by parabolic interpolation.
+A parabola is fitted to the logarithmic power of the peak and its neighbours, its vertex lies within half a bin of the peak.
+The error is far below the bin width for windows with a smooth main lobe like hann or gauss, larger for the rectangle window.
+@param peak the peak found by findSpectralPeak
+@return position the fractional bin of the peak, frequency*sampleSize/sampleRate, the bin itself if a neighbour has no power
+**/
+double getPeakPosition(const SpectralPeak *peak);
+
+/**
+@brief This function prepares a constant q transform for the frames of one frame loop.
+The bins cover the six octaves of the notes that getBins searches, starting at c with 32.7Hz for a tuning pitch of 440Hz. Every note
+lies in the middle of its binsPerOctave/12 bins. The sparse kernel of the top octave is calculated once per configuration and cached.
+@param cqt the constant q transform to initialize
+@param fftEngineName the fft engine for the ffts of every octave, as for open_fft_engine
+@param sampleSize the size of the frames, the bins are written to the positions of a fft of this size
+@param stepSize the number of new samples at the end of the frame for every call of analyzeConstantQ
+@param sampleRate the sample rate of the audio data
+@param tuningPitch the reference frequency used (generally a4->440Hz)
+@param binsPerOctave 12 for semitone bins, 36 for third-tone bins, any odd multiple of 12 is accepted
+@return isSuccess 1 if the transform was initialized, 0 otherwise
+**/
+int initConstantQTransform(ConstantQTransform *cqt, char *fftEngineName, int sampleSize, int stepSize, double sampleRate, double tuningPitch, int binsPerOctave);
+
+/**
+@brief This function calculates the constant q bins of the current frame.
+It replaces windowing, fft and getPowerSpectrum. The power of every bin is written to the position floor(f*sampleSize/sampleRate) of its center
+frequency f in amps, bins that share a position keep the loudest one. Thereby getFrequencyBin and getBins find the note bins in amps,
+getConstantQFrequency gives the frequency of a position. All the other positions of amps are left untouched.
+@param cqt the constant q transform
+@param inputReal the unwindowed frame of sampleSize samples, the last stepSize samples are the new ones
+@param amps array of the power of sampleSize/2+1 bins
+**/
+void analyzeConstantQ(ConstantQTransform *cqt, const sample_t *inputReal, sample_t *amps);
+
+/**
+@brief This function returns the center frequency of the constant q bin at a position of the amplitude array.
+The frequency of a position found by getFrequencyBin or getBins is more precise than position*sampleRate/sampleSize, especially for low notes.
+@param cqt the constant q transform
+@param position the position in the amplitude array of the last call of analyzeConstantQ
+@return frequency the center frequency of the loudest bin at the position, position*sampleRate/sampleSize if no bin was written there
+**/
+double getConstantQFrequency(ConstantQTransform *cqt, int position);
+
+/**
+@brief This function frees memory space taken by a constant q transform, the cached kernel is kept.
+@param cqt the constant q transform
+**/
+void freeConstantQTransform(ConstantQTransform *cqt);
+
+/**
+@brief This function frees all cached constant q kernels.
+**/
+void freeConstantQKernels(void);
 
 #endif // AUDIOPREPROCESSING_H_INCLUDED
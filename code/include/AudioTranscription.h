@@ -9,9 +9,11 @@
 #define AUDIOTRANSCRIPTION_H_INCLUDED
 
 #include "../include/Structures.h"
+#include "../include/ApplicationMacros.h"
 
 /**
 @brief This function is possible to find the bins with the numBins maximal frequencies.
+It is getPeakBins with the note table of the configuration.
 @param bins array to save the indexes of the calculated bins
 @param numBins number of bins for which the indexes should be find out
 @param out array which holds the power levels of the different bins
@@ -19,7 +21,7 @@
 @param Fs sample rate
 @param tuningPitch the reference frequency used (generally a4->440Hz)
 **/
-void getBins(int *bins, int numBins, double *out, int N, double Fs, double tuningPitch);
+void getBins(int *bins, int numBins, sample_t *out, int N, double Fs, double tuningPitch);
 
 /**
 @brief This function returns the corresponding frequency to a musical note.
@@ -100,6 +102,73 @@ double getDurationOfAudioFileInSeconds(char *audioFile);
 char *getMusicalNote(double frequency, double tuningPitch, double pitchResolution);
 //char *getMusicalNote(double frequency, double tuningPitch);
 
+/**
+@brief This function calculates the midi note of a frequency.
+@param frequency the frequency which was extracted in earlier stages of the pipeline
+@param tuningPitch specifies the reference tone (generally a4->440Hz)
+@param pitchResolution defines margin for note detection, specified in cent
+@param cents receives the difference in cents of the frequency to the nearest note, may be NULL
+@return midiNote the midi note number, 60 is c', NO_MIDI_NOTE if the frequency is more than pitchResolution cents away from the nearest note
+or not between NOTE_LOWEST_FREQUENCY and NOTE_HIGHEST_FREQUENCY
+**/
+int getMidiNote(double frequency, double tuningPitch, double pitchResolution, double *cents);
+
+/**
+@brief This function renders a midi note in lilypond format.
+It is meant for the moment a note is emitted, the frame loops compare the midi note numbers.
+@param midiNote the midi note number, 60 is c'
+@return musicalNote the musical note in lilypond format, an empty string for NO_MIDI_NOTE, has to be freed
+**/
+char *getLilyPondNote(int midiNote);
+
+/**
+@brief This function returns the cached note table of a configuration and calculates it on first use.
+@param sampleSize the sample size of the fft
+@param sampleRate the sample rate of the audio data
+@param tuningPitch specifies the reference tone (generally a4->440Hz)
+@param pitchResolution defines margin for note detection, specified in cent
+@return noteTable the table, valid until freeNoteTables is called
+**/
+const NoteTable *getNoteTable(int sampleSize, double sampleRate, double tuningPitch, double pitchResolution);
+
+/**
+@brief This function looks up the midi note of a bin.
+@param noteTable the note table of the frame loop
+@param bin the bin, 0..sampleSize/2
+@param cents receives the difference in cents of the frequency of the bin to the nearest note, may be NULL
+@return midiNote the midi note number as returned by getMidiNote for the frequency of the bin
+**/
+int getNoteOfBin(const NoteTable *noteTable, int bin, double *cents);
+
+/**
+@brief This function looks up the midi note of a fractional bin, e.g. of an interpolated peak or of a constant q frequency.
+The note position is linearly interpolated between the neighbouring bins, which is exact to 0.25 cents from bin 32 on.
+Lower bins calculate the logarithm of the frequency directly.
+@param noteTable the note table of the frame loop
+@param position the fractional bin, frequency*sampleSize/sampleRate
+@param cents receives the difference in cents to the nearest note, may be NULL
+@return midiNote the midi note number as returned by getMidiNote for the frequency of the position
+**/
+int getNoteOfBinPosition(const NoteTable *noteTable, double position, double *cents);
+
+/**
+@brief This function finds the bins of the loudest notes of a spectrum, e.g. the notes of a chord.
+Only the note bins of the note table are looked at. A note counts if its peak is a local maximum louder than a magnitude of 1 and
+not an overtone, i.e. at a harmonic of a note that is louder by more than the HARMONIC_SUPPRESSION_FACTOR. Bin 0 is never returned.
+The notes are kept in a heap of numBins entries, nothing is allocated.
+@param bins receives the note bins sorted by descending power, the entries after the found ones are set to 0
+@param numBins number of bins to find, at most NUM_NOTE_BINS are found
+@param amps the power of the sampleSize/2+1 bins of the spectrum
+@param noteTable the note table of the frame loop
+@return numFound the number of bins found
+**/
+int getPeakBins(int *bins, int numBins, const sample_t *amps, const NoteTable *noteTable);
+
+/**
+@brief This function frees all cached note tables.
+**/
+void freeNoteTables(void);
+
 /**
 @brief This function calculates the frequency to a musical expression.
 @param musicalExpression string containing a musical note in lilypond format
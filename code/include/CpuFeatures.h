@@ -0,0 +1,23 @@
+/**
+@file CpuFeatures.h
+The vectorized kernels are compiled for several instruction sets into the same binary. Which of them can
+be used is decided at runtime by asking the processor (CPUID on x86, HWCAP on ARM).
+@author Lukas Graber
+@date 30 May 2019
+@brief Functions to detect instruction set extensions at runtime.
+**/
+#ifndef CPUFEATURES_H_INCLUDED
+#define CPUFEATURES_H_INCLUDED
+
+#define CPU_FEATURE_SSE2 1   ///< x86 SSE2 instructions are available
+#define CPU_FEATURE_AVX2 2   ///< x86 AVX2 instructions are available
+#define CPU_FEATURE_NEON 4   ///< ARM NEON (Advanced SIMD) instructions are available
+
+/**
+@brief This function detects the instruction set extensions of the processor.
+The detection runs only once, later calls return the stored result.
+@return features bit mask of CPU_FEATURE_* flags
+**/
+int getCpuFeatures(void);
+
+#endif // CPUFEATURES_H_INCLUDED
@@ -11,6 +11,181 @@ Sources are from: https://www.nayuki.io/page/free-small-fft-in-multiple-language
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "ApplicationMacros.h"
+
+/**
+@brief Implementations of the power of two fft.
+The radix-2 kernel is the original algorithm. The other kernels fuse two stages into one radix-4 stage,
+the vectorized ones are only available if the processor supports the instruction set.
+**/
+enum FftKernel{
+    FFT_KERNEL_RADIX2,      ///< scalar radix-2 kernel
+    FFT_KERNEL_RADIX4,      ///< scalar radix-4 kernel
+    FFT_KERNEL_SSE2,        ///< radix-4 kernel vectorized with SSE2 (x86)
+    FFT_KERNEL_AVX2,        ///< radix-4 kernel vectorized with AVX2 (x86)
+    FFT_KERNEL_NEON,        ///< radix-4 kernel vectorized with NEON (ARM)
+    FFT_KERNEL_CODELET,     ///< radix-4 kernel generated for the size of the plan, only for the sizes of CODELET_SIZES
+    FFT_KERNEL_STOCKHAM,    ///< scalar radix-2 Stockham kernel, which needs no bit reversal but a scratch buffer
+    FFT_NUM_KERNELS         ///< number of kernels
+};
+typedef enum FftKernel FftKernel; ///< use the enum without the keyword enum
+
+/**
+@brief In-place fft of one fixed size, generated by FFTCodeletGenerator.py.
+**/
+typedef void (*FftCodelet)(sample_t *restrict real, sample_t *restrict imag);
+
+/**
+@brief Precomputed tables for one fft size.
+The plan holds the twiddle factors and the bit reversal permutation of one size, such that
+a transform neither allocates memory nor evaluates trigonometric functions. Sizes that are no power
+of two are transformed with Bluestein's algorithm, its chirp, kernel spectrum and buffers are part of the plan.
+A plan must therefore not be used by two threads at the same time. Planned transforms run in
+the precision of sample_t, the unplanned functions below always use double precision.
+**/
+struct FftPlan{
+    size_t n;               ///< size of the transform
+    int levels;             ///< log2 of the size
+    sample_t *cosTable;     ///< cos(2*pi*i/n) for i < n/2
+    sample_t *sinTable;     ///< sin(2*pi*i/n) for i < n/2
+    size_t *swaps;          ///< index pairs that are exchanged by the bit reversal permutation
+    size_t numSwaps;        ///< number of index pairs in swaps
+    FftKernel kernel;       ///< kernel that runs the transform
+    FftCodelet codelet;     ///< codelet of the size for the instruction set of this processor, NULL if the size has none
+    sample_t *radix4Twiddles; ///< twiddle factors of the radix-4 stages
+    struct FftPlan *convolution; ///< power of two plan of the Bluestein convolution, NULL for power of two sizes
+    sample_t *chirpCos;     ///< cos(pi*i*i/n) for i < n, only for Bluestein plans
+    sample_t *chirpSin;     ///< sin(pi*i*i/n) for i < n, only for Bluestein plans
+    sample_t *kernelReal;   ///< real part of the spectrum of the Bluestein kernel divided by the convolution size
+    sample_t *kernelImag;   ///< imaginary part of the spectrum of the Bluestein kernel divided by the convolution size
+    sample_t *workReal;     ///< buffer of the convolution size for the real part, only for Bluestein plans
+    sample_t *workImag;     ///< buffer of the convolution size for the imaginary part, only for Bluestein plans
+    sample_t *scratchReal;  ///< buffer of the plan size for the real part, allocated when the Stockham kernel is selected
+    sample_t *scratchImag;  ///< buffer of the plan size for the imaginary part, allocated when the Stockham kernel is selected
+    struct FftPlan *half;   ///< cached plan of half the size, used by the real transform
+    struct FftPlan *next;   ///< next plan in the plan cache
+};
+typedef struct FftPlan FftPlan; ///< use the data structure without the keyword struct
+
+/**
+@brief This function creates a plan for an fft size.
+@param n size of the transform
+@return plan the created plan or NULL if n is zero or memory is exhausted
+**/
+FftPlan *Fft_createPlan(size_t n);
+
+/**
+@brief This function frees memory space occupied by a plan that was created with Fft_createPlan.
+@param plan the plan to destroy
+**/
+void Fft_destroyPlan(FftPlan *plan);
+
+/**
+@brief This function returns the cached plan for a size and creates it on first use.
+The cache is local to the calling thread.
+@param n size of the transform
+@return plan the cached plan or NULL if no plan can be created for n
+**/
+FftPlan *Fft_getPlan(size_t n);
+
+/**
+@brief This function frees all the plans cached by the calling thread.
+**/
+void Fft_freePlans(void);
+
+/**
+@brief This function runs an in-place fft with precomputed tables and the kernel selected in the plan.
+@param plan plan for the size of the arrays
+@param real real part of the data
+@param imag imaginary part of the data
+@return isSuccess false if there is no valid plan
+**/
+bool Fft_transformPlanned(const FftPlan *plan, sample_t real[], sample_t imag[]);
+
+/**
+@brief This function selects the kernel that runs the transforms of a plan.
+@param plan the plan to change
+@param kernel the kernel to use
+@return isSuccess false if the processor does not support the kernel or there is no codelet for the size of the plan
+**/
+bool Fft_setKernel(FftPlan *plan, FftKernel kernel);
+
+/**
+@brief This function checks if a kernel can run on this processor.
+@param kernel the kernel to check
+@return isSupported true if the kernel can be used
+**/
+bool Fft_isKernelSupported(FftKernel kernel);
+
+/**
+@brief This function returns the fastest kernel for all sizes that is supported by this processor.
+Plans of the sizes with a codelet use FFT_KERNEL_CODELET instead.
+@return kernel the best supported kernel
+**/
+FftKernel Fft_getBestKernel(void);
+
+/**
+@brief This function returns a short name of a kernel, e.g. for benchmark output.
+@param kernel the kernel
+@return name the name of the kernel
+**/
+const char *Fft_getKernelName(FftKernel kernel);
+
+/**
+@brief This function returns the codelet of a size for the instruction set of this processor.
+The codelet is looked up once when a plan is created, transforms call it directly.
+@param n size of the transform
+@return codelet the codelet or NULL if no codelet was generated for n
+**/
+FftCodelet Fft_getCodelet(size_t n);
+
+/**
+@brief This function precomputes the twiddle factors of the radix-4 stages of a plan.
+@param plan the plan whose radix4Twiddles are allocated and filled
+@return isSuccess false if memory is exhausted
+**/
+bool Fft_initRadix4Twiddles(FftPlan *plan);
+
+/**
+@brief This function applies the bit reversal permutation of a plan.
+@param plan plan for the size of the arrays
+@param real real part of the data
+@param imag imaginary part of the data
+**/
+void Fft_bitReverse(const FftPlan *plan, sample_t real[], sample_t imag[]);
+
+/**
+@brief This function runs an in-place radix-4 fft with the kernel selected in the plan.
+@param plan plan for the size of the arrays
+@param real real part of the data
+@param imag imaginary part of the data
+@return isSuccess false if there is no valid plan
+**/
+bool Fft_transformRadix4(const FftPlan *plan, sample_t real[], sample_t imag[]);
+
+/**
+@brief This function runs an in-place radix-2 fft with the Stockham autosort algorithm.
+Every stage reads from one buffer and writes to the other one in the order of the next stage, such that
+the output is in natural order without the scattered bit reversal permutation.
+@param plan plan for the size of the arrays, its scratch buffers are allocated by Fft_setKernel
+@param real real part of the data
+@param imag imaginary part of the data
+@return isSuccess false if there is no valid plan or it has no scratch buffers
+**/
+bool Fft_transformStockham(const FftPlan *plan, sample_t real[], sample_t imag[]);
+
+/**
+@brief This function runs an fft on purely real input data.
+For an even size the n real samples are packed into n/2 complex values, such that only an fft of half the size is needed.
+Only the n/2+1 non-redundant bins are written, the others are the complex conjugates of them.
+@param plan plan obtained by Fft_getPlan for the size n of the input
+@param input the n real samples
+@param outReal real part of the spectrum, needs space for n/2+1 values
+@param outImag imaginary part of the spectrum, needs space for n/2+1 values
+@return isSuccess false if there is no valid plan
+**/
+bool Fft_transformReal(const FftPlan *plan, const sample_t input[], sample_t outReal[], sample_t outImag[]);
+
 bool Fft_transform(double real[], double imag[], size_t n);
 bool Fft_inverseTransform(double real[], double imag[], size_t n);
 bool Fft_transformRadix2(double real[], double imag[], size_t n);
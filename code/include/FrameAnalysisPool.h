@@ -0,0 +1,88 @@
+/**
+@file FrameAnalysisPool.h
+@author Lukas Graber
+@date 30 May 2019
+@brief Functions that analyze the overlapping frames of the hops on several threads and return the results in the order of the hops.
+**/
+#ifndef FRAMEANALYSISPOOL_H_INCLUDED
+#define FRAMEANALYSISPOOL_H_INCLUDED
+
+#include "ApplicationMacros.h"
+#include "Structures.h"
+
+/**
+@brief This function starts the analysis threads of a pool, nothing is allocated afterwards.
+The analyzer, fft engine, window, frame and hop size, tuning pitch and peak interpolation are taken from the configuration.
+The sliding-dft and constant-q analyzers always run on a single thread.
+@param pool the pool to initialize
+@param config the configuration of the frame loop
+@param sampleRate the sample rate of the audio data
+@param numWorkers the number of analysis threads, 0 for one per online core from firstCore on, at least one
+@param firstCore the core the first analysis thread is pinned to, the others follow on the cores up to the last one and share them if
+there are more threads than cores. The cores below it are left to the pinned threads of the pipeline, the analysis threads are not pinned
+if there is no core left for them. -1 to not pin the threads
+@return isSuccess 1 if the pool was initialized, 0 otherwise
+**/
+int initFrameAnalysisPool(FrameAnalysisPool *pool, const RunTimeInformation *config, double sampleRate, int numWorkers, int firstCore);
+
+/**
+@brief This function stages the frame of a hop and queues it for the next analysis thread.
+It blocks while the reorder buffer or the queue of the thread is full. Only one thread submits frames.
+@param pool the pool
+@param samples the stepSize new samples of the hop
+@param captureTime the capture time of the hop in milliseconds
+@param isSkipped 1 if the hop is only added to the history and not analyzed
+**/
+void submitFrame(FrameAnalysisPool *pool, const short *samples, double captureTime, int isSkipped);
+
+/**
+@brief This function checks whether submitFrame would block because the oldest spectral frame is not read yet.
+A thread that submits and reads the frames reads one first if the pool is full.
+@param pool the pool
+@return isFull 1 if the pool is full
+**/
+int isFrameAnalysisPoolFull(FrameAnalysisPool *pool);
+
+/**
+@brief This function returns the spectral frame of the oldest hop that was not read yet, if it is analyzed.
+@param pool the pool
+@return spectralFrame the frame, valid until releaseSpectralFrame, NULL if the hop is not analyzed yet
+**/
+const SpectralFrame *peekSpectralFrame(FrameAnalysisPool *pool);
+
+/**
+@brief This function blocks until the spectral frame of the oldest hop that was not read yet is analyzed.
+@param pool the pool
+@return spectralFrame the frame, valid until releaseSpectralFrame, NULL if the pool is closed and all frames were read
+**/
+const SpectralFrame *waitSpectralFrame(FrameAnalysisPool *pool);
+
+/**
+@brief This function returns the slot of the last spectral frame that was read to the pool.
+@param pool the pool
+**/
+void releaseSpectralFrame(FrameAnalysisPool *pool);
+
+/**
+@brief This function ends the hops, it is called by the submitting thread after its last submitFrame.
+It waits for the analysis threads to finish the queued frames and end, waitSpectralFrame returns NULL after the last frame.
+@param pool the pool
+**/
+void closeFrameAnalysisPool(FrameAnalysisPool *pool);
+
+/**
+@brief This function returns the times of the analysis threads.
+@param pool the pool, closed with closeFrameAnalysisPool
+@param stageTime receives the milliseconds of the busiest thread, which bound the throughput of the pool
+@param analysisTime receives the summed milliseconds of all threads
+@param fftTime receives the summed milliseconds of the ffts, note banks or constant q transforms of all threads
+**/
+void getFrameAnalysisTimes(const FrameAnalysisPool *pool, double *stageTime, double *analysisTime, double *fftTime);
+
+/**
+@brief This function frees memory space taken by a pool.
+@param pool the pool, closed with closeFrameAnalysisPool
+**/
+void freeFrameAnalysisPool(FrameAnalysisPool *pool);
+
+#endif // FRAMEANALYSISPOOL_H_INCLUDED
@@ -8,12 +8,60 @@
 #ifndef HELPERFUNCTIONS_H_INCLUDED
 #define HELPERFUNCTIONS_H_INCLUDED
 
+#include <pthread.h>
+
+#include "ApplicationMacros.h"
+
 /**
 @brief This function stalls the execution of the program for d milliseconds.
 @param d time to sleep in milliseconds
 **/
 void msleep(int d);
 
+/**
+@brief This function blocks the calling thread as long as an int still has an expected value.
+It may return early, the caller checks the value again.
+@param address the int, shared with the thread that calls futexWake
+@param expected the value for which the thread sleeps
+**/
+void futexWait(int *address, int expected);
+
+/**
+@brief This function wakes all threads that wait in futexWait on an int.
+@param address the int
+**/
+void futexWake(int *address);
+
+/**
+@brief This function reads a flag that is shared between threads.
+@param flag the flag
+@return value the value last stored with setFlag
+**/
+int getFlag(int *flag);
+
+/**
+@brief This function sets a flag that is shared between threads and wakes the threads that wait for it.
+The writes before the call are visible to a thread that sees the new value.
+@param flag the flag
+@param value the new value
+**/
+void setFlag(int *flag, int value);
+
+/**
+@brief This function blocks the calling thread until a flag has a value, without polling.
+@param flag the flag, changed with setFlag
+@param value the value to wait for
+**/
+void waitFlag(int *flag, int value);
+
+/**
+@brief This function pins a thread to one core, such that the stages of a pipeline do not share a core and keep their caches.
+@param thread the thread
+@param core the core, taken modulo the number of online cores
+@return isSuccess 1 if the thread was pinned, 0 otherwise
+**/
+int pinThreadToCore(pthread_t thread, int core);
+
 /**
 @brief This function deep copies an array.
 @param src the memory location from where to copy
@@ -22,7 +70,7 @@ void msleep(int d);
 **/
 void *copyArray(const void *src, size_t n);
 
-void shiftWrite(double *arr,short *buff,int arrSize, int buffSize);
+void shiftWrite(sample_t *arr,short *buff,int arrSize, int buffSize);
 
 /**
 @brief This function returns the concatenation of two strings.
@@ -0,0 +1,52 @@
+/**
+@file NoteBank.h
+@author Lukas Graber
+@date 30 May 2019
+@brief Functions that evaluate the spectrum only at the bins of the musical notes.
+@see https://en.wikipedia.org/wiki/Goertzel_algorithm
+@see https://en.wikipedia.org/wiki/Sliding_DFT
+**/
+#ifndef NOTEBANK_H_INCLUDED
+#define NOTEBANK_H_INCLUDED
+
+#include "ApplicationMacros.h"
+#include "Structures.h"
+
+#define NOTE_BANK_GOERTZEL 0      ///< every bin is calculated from the windowed frame with the goertzel recurrence
+#define NOTE_BANK_SLIDING_DFT 1   ///< every bin is updated with each new sample, the window is applied in the frequency domain
+
+/**
+@brief This function prepares a note bank for the frames of one frame loop.
+The bins are the ones that getBins looks at, i.e. floor(f*N/Fs) of the 72 notes of the six octaves starting at 32.7Hz (for a tuning pitch of 440Hz).
+The sliding-dft analyzer needs a cosine sum window (rectangle, hann, hamming, blackman, nuttall, flattop, ...), for any other
+window the goertzel analyzer is used instead.
+@param bank the note bank to initialize
+@param analyzerName name of the analyzer\n options: goertzel, sliding-dft
+@param sampleSize the size of the frames
+@param stepSize the number of new samples at the end of the frame for every call of analyzeNoteBank
+@param sampleRate the sample rate of the audio data
+@param tuningPitch the reference frequency used (generally a4->440Hz)
+@param numNeighbours number of bins on each side of a note bin that are evaluated as well
+@param windowingFunctionName the window that is applied to the frames, as for applyWindowingFunction
+@param kaiserBeta the shape parameter of the window if it is the kaiser window
+@return isSuccess 1 if the note bank was initialized, 0 for an unknown analyzer
+**/
+int initNoteBank(NoteBank *bank, char *analyzerName, int sampleSize, int stepSize, double sampleRate, double tuningPitch, int numNeighbours, char *windowingFunctionName, double kaiserBeta);
+
+/**
+@brief This function calculates the power of the note bins of the current frame.
+It replaces windowing, fft and getPowerSpectrum. The power has the same scale as the one of getPowerSpectrum
+and is written to the same positions, all the other bins of amps are left untouched.
+@param bank the note bank
+@param inputReal the unwindowed frame of sampleSize samples, the last stepSize samples are the new ones
+@param amps array of the power of sampleSize/2+1 bins
+**/
+void analyzeNoteBank(NoteBank *bank, const sample_t *inputReal, sample_t *amps);
+
+/**
+@brief This function frees memory space taken by a note bank.
+@param bank the note bank
+**/
+void freeNoteBank(NoteBank *bank);
+
+#endif // NOTEBANK_H_INCLUDED
@@ -0,0 +1,42 @@
+/**
+@file NoteTracker.h
+@author Lukas Graber
+@date 30 May 2019
+@brief Functions that segment the detected notes of the frame loops into notes and rests.
+**/
+#ifndef NOTETRACKER_H_INCLUDED
+#define NOTETRACKER_H_INCLUDED
+
+#include "ApplicationMacros.h"
+#include "Structures.h"
+
+/**
+@brief This function prepares a note tracker for one frame loop, it starts with a rest at the time 0.
+The hysteresis of NOTE_ONSET_TIME and NOTE_OFFSET_TIME is rounded up to whole hops.
+@param tracker the note tracker to initialize
+@param hopDuration the duration of one hop in milliseconds, stepSize*1000/sampleRate
+**/
+void initNoteTracker(NoteTracker *tracker, double hopDuration);
+
+/**
+@brief This function passes the midi note of the current hop to the note tracker.
+Nothing is allocated, the finished note is written to event.
+@param tracker the note tracker
+@param midiNote the midi note of the hop, NO_MIDI_NOTE if no note was detected
+@param frequency the frequency of the hop
+@param time the time of the hop in milliseconds
+@param event receives the finished note or rest if the hop completes an onset or offset
+@return isFinished 1 if event was written, 0 otherwise
+**/
+int updateNoteTracker(NoteTracker *tracker, int midiNote, double frequency, double time, NoteEvent *event);
+
+/**
+@brief This function finishes the current note or rest of a note tracker at the end of a frame loop.
+@param tracker the note tracker
+@param time the time at the end of the frame loop in milliseconds
+@param event receives the current note or rest
+@return isFinished 1 if event was written, 0 if the current note or rest has no duration
+**/
+int finishNoteTracker(NoteTracker *tracker, double time, NoteEvent *event);
+
+#endif // NOTETRACKER_H_INCLUDED
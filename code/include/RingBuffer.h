@@ -0,0 +1,183 @@
+/**
+@file RingBuffer.h
+@author Lukas Graber
+@date 30 May 2019
+@brief Functions that hand preallocated slots from one pipeline thread to the next without locks, e.g. the captured audio data.
+**/
+#ifndef RINGBUFFER_H_INCLUDED
+#define RINGBUFFER_H_INCLUDED
+
+#include "ApplicationMacros.h"
+#include "Structures.h"
+
+/**
+@brief This function allocates the zeroed slots of a ring, nothing is allocated afterwards.
+@param ring the ring to initialize
+@param minSlots the number of slots the ring needs at least, it is rounded up to a power of 2
+@param slotBytes the size of every slot in bytes
+@return isSuccess 1 if the ring was initialized, 0 otherwise
+**/
+int initRingBuffer(RingBuffer *ring, size_t minSlots, size_t slotBytes);
+
+/**
+@brief This function allocates a ring of audio capture points together with their sample arrays.
+@param ring the ring to initialize
+@param minSlots the number of slots the ring needs at least, it is rounded up to a power of 2
+@param slotSize the number of samples of every slot
+@return isSuccess 1 if the ring was initialized, 0 otherwise
+**/
+int initAudioRingBuffer(RingBuffer *ring, size_t minSlots, size_t slotSize);
+
+/**
+@brief This function makes the producer drop the oldest unread slot instead of waiting while the ring is full.
+The consumer calls it before it reads the first slot. The producer still waits while the consumer holds the oldest slot,
+i.e. for at most the processing of one slot.
+@param ring the ring
+**/
+void setRingDropOldest(RingBuffer *ring);
+
+/**
+@brief This function returns the next free slot to the producer.
+The slot is filled in place and handed to the consumer by publishRingSlot.
+@param ring the ring
+@return slot the free slot, NULL if the ring is full and its oldest slot cannot be dropped
+**/
+void *reserveRingSlot(RingBuffer *ring);
+
+/**
+@brief This function hands the reserved slot to the consumer.
+@param ring the ring
+**/
+void publishRingSlot(RingBuffer *ring);
+
+/**
+@brief This function returns the oldest published slot to the consumer.
+The slot stays valid until releaseRingSlot is called.
+@param ring the ring
+@return slot the oldest published slot, NULL if the ring is empty
+**/
+void *peekRingSlot(RingBuffer *ring);
+
+/**
+@brief This function returns the slot of the last peekRingSlot to the producer.
+@param ring the ring
+**/
+void releaseRingSlot(RingBuffer *ring);
+
+/**
+@brief This function blocks the producer until a slot is free and returns it.
+Every call that finds the ring full counts as an overrun, unless the oldest slot is dropped instead.
+@param ring the ring
+@return slot the free slot
+**/
+void *waitFreeRingSlot(RingBuffer *ring);
+
+/**
+@brief This function blocks the consumer until a slot is published or the ring is closed.
+@param ring the ring
+@return slot the oldest published slot, NULL if the ring is closed and all slots were read
+**/
+void *waitRingSlot(RingBuffer *ring);
+
+/**
+@brief This function ends the stream of slots, it is called by the producer after its last publishRingSlot.
+The consumer reads the remaining slots, then waitRingSlot returns NULL.
+@param ring the ring
+**/
+void closeRingBuffer(RingBuffer *ring);
+
+/**
+@brief This function returns how long ago a slot was captured.
+@param ring the ring
+@param time the capture time of the slot in milliseconds after the start time of the ring
+@return lag the milliseconds since the capture time
+**/
+double getRingLag(RingBuffer *ring, double time);
+
+/**
+@brief This function allocates the slots of a reorder buffer, nothing is allocated afterwards.
+@param buffer the reorder buffer to initialize
+@param minSlots the number of slots the buffer needs at least, it is rounded up to a power of 2
+@param slotBytes the size of the data of every slot in bytes
+@return isSuccess 1 if the buffer was initialized, 0 otherwise
+**/
+int initReorderBuffer(ReorderBuffer *buffer, size_t minSlots, size_t slotBytes);
+
+/**
+@brief This function blocks the producer until the slot of the next sequence number is free and hands the number out.
+@param buffer the reorder buffer
+@return sequence the next sequence number, starting at 0
+**/
+size_t waitReorderSequence(ReorderBuffer *buffer);
+
+/**
+@brief This function checks whether the producer would block in waitReorderSequence.
+A producer that is also the consumer reads a slot first if the buffer is full.
+@param buffer the reorder buffer
+@return isFull 1 if the slot of the next sequence number is not read yet
+**/
+int isReorderBufferFull(ReorderBuffer *buffer);
+
+/**
+@brief This function returns the data of the slot of a sequence number that was handed out and is not published yet.
+@param buffer the reorder buffer
+@param sequence the sequence number
+@return slot the data of the slot
+**/
+void *getReorderSlot(ReorderBuffer *buffer, size_t sequence);
+
+/**
+@brief This function publishes the filled slot of a sequence number, it may be called by any thread.
+@param buffer the reorder buffer
+@param sequence the sequence number
+**/
+void publishReorderSlot(ReorderBuffer *buffer, size_t sequence);
+
+/**
+@brief This function returns the slot of the oldest sequence number to the consumer if it is published.
+The slot stays valid until releaseReorderSlot is called.
+@param buffer the reorder buffer
+@return slot the data of the slot, NULL if it is not published yet
+**/
+void *peekReorderSlot(ReorderBuffer *buffer);
+
+/**
+@brief This function blocks the consumer until the slot of the oldest sequence number is published or all slots are read.
+@param buffer the reorder buffer
+@return slot the data of the slot, NULL if the buffer is closed and all handed out sequence numbers were read
+**/
+void *waitReorderSlot(ReorderBuffer *buffer);
+
+/**
+@brief This function frees the slot of the last peekReorderSlot or waitReorderSlot for the producer.
+@param buffer the reorder buffer
+**/
+void releaseReorderSlot(ReorderBuffer *buffer);
+
+/**
+@brief This function ends the sequence, it is called by the producer after it handed out the last sequence number.
+The consumer reads the slots of all handed out sequence numbers, then waitReorderSlot returns NULL.
+@param buffer the reorder buffer
+**/
+void closeReorderBuffer(ReorderBuffer *buffer);
+
+/**
+@brief This function frees memory space taken by the slots of a reorder buffer.
+@param buffer the reorder buffer
+**/
+void freeReorderBuffer(ReorderBuffer *buffer);
+
+/**
+@brief This function resolves the name of a backpressure policy.
+@param policyName the name of the policy, e.g. drop-oldest
+@return policy the policy, BACKPRESSURE_BLOCK for an unknown name
+**/
+BackpressurePolicy getBackpressurePolicy(char *policyName);
+
+/**
+@brief This function frees memory space taken by the slots of a ring.
+@param ring the ring
+**/
+void freeRingBuffer(RingBuffer *ring);
+
+#endif // RINGBUFFER_H_INCLUDED
@@ -11,6 +11,8 @@
 #ifndef STRUCTURES_H_INCLUDED
 #define STRUCTURES_H_INCLUDED
 
+#include <pthread.h>
+
 #include "./ApplicationMacros.h"
 /**
 @brief Structure for musical data point.
@@ -115,72 +117,341 @@ void freeAudioCapturePoint(AudioCapturePoint *cP);
 
 
 /**
-@brief defines one node of the queue
+@brief What the threaded version does when the processing falls behind the capture, resolved from its name by getBackpressurePolicy.
+**/
+enum BackpressurePolicy{
+    BACKPRESSURE_BLOCK,         ///< block, every hop is analyzed and the capture thread waits while the ring is full
+    BACKPRESSURE_DROP_OLDEST,   ///< drop-oldest, the capture thread does not wait while the ring is full but overwrites the oldest period that was not read yet
+    BACKPRESSURE_DEGRADE        ///< degrade, every second hop that missed the deadline is not analyzed
+};
+typedef enum BackpressurePolicy BackpressurePolicy; ///< use the enumeration without the keyword enum
+
+/**
+@brief Ring of preallocated slots that several producers fill out of order and a single consumer reads in the order of their sequence numbers.
+The producer that hands out the sequence numbers, e.g. the thread that dispatches the frames to the workers, only advances head
+while the slot of the sequence number is free. Any thread may then fill the slot of a sequence number and publish it by storing
+the sequence number plus 1 in front of the slot. The consumer waits for the slot at tail to be published, such that a slot that is
+finished early waits in the ring until all slots before it are read. The slots are aligned to cache lines, such that producers that
+fill neighbouring slots do not share a line.
+**/
+struct ReorderBuffer{
+    char *slots;              ///< numSlots slots of slotStride bytes, the published sequence number plus 1 followed by the data
+    size_t slotStride;        ///< distance of the slots in bytes, a multiple of CACHE_LINE_SIZE
+    size_t numSlots;          ///< number of slots, a power of 2
+    size_t mask;              ///< numSlots-1, maps a sequence number to its slot
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE))); ///< number of sequence numbers handed out by the producer
+    size_t cachedTail;        ///< tail as last seen by the producer
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE))); ///< number of slots read by the consumer
+    int numWakeups;           ///< how often the consumer was woken up by a published slot
+    double wakeupLatency;     ///< summed milliseconds from the wake up call to the running consumer
+    int headEvent __attribute__((aligned(CACHE_LINE_SIZE))); ///< counts the wake ups of the consumer, its futex
+    int tailEvent;            ///< counts the wake ups of the producer, its futex
+    int consumerWaiting;      ///< 1 while the consumer is about to sleep on headEvent
+    int producerWaiting;      ///< 1 while the producer is about to sleep on tailEvent
+    int closed;               ///< 1 after the producer handed out its last sequence number
+    long long wakeTime;       ///< monotonic nanoseconds of the last wake up of the consumer
+    char padding[CACHE_LINE_SIZE - 5 * sizeof(int) - sizeof(long long)]; ///< keeps the following data off the line of the events
+};
+typedef struct ReorderBuffer ReorderBuffer;///< use the data structure without the keyword struct
+
+/**
+@brief Result of the spectral analysis of one hop, handed from a frame analysis thread to the note tracking.
+The frames are preallocated in the slots of a reorder buffer, nothing but the peak of the spectrum is copied.
+**/
+struct SpectralFrame{
+    double captureTime; ///< capture time of the hop in milliseconds
+    int isSkipped;      ///< 1 if the hop was dropped by the backpressure policy, the note tracker holds the last note
+    int frequencyBin;   ///< bin of the loudest frequency
+    int isFractional;   ///< 1 if the note is looked up at position, 0 if at frequencyBin
+    double position;    ///< fractional bin of the loudest frequency, frequency*sampleSize/rate
+    double frequency;   ///< the loudest frequency in Hz
+};
+typedef struct SpectralFrame SpectralFrame;///< use the data structure without the keyword struct
+
+/**
+@brief Frame that is queued for an analysis thread of a frame analysis pool, the samples follow the structure in the slot of the queue.
+**/
+struct FrameJob{
+    size_t sequence;    ///< sequence number of the hop, its slot in the reorder buffer of the results
+    double captureTime; ///< capture time of the hop in milliseconds
+    int isSkipped;      ///< 1 if the hop is not analyzed, see SpectralFrame
+    sample_t frame[];   ///< sampleSize samples, windowed for the fft, unwindowed for the note bank and the constant q transform
+};
+typedef struct FrameJob FrameJob;///< use the data structure without the keyword struct
+
+/**
+@brief Single producer single consumer ring of preallocated slots, e.g. audio capture points or frame jobs.
+This data structure is shared by two neighbouring threads of the pipeline. The producer fills the slot at head and publishes
+it by advancing head, the consumer reads the slot at tail and returns it by advancing tail. Each index is written by one
+thread only and lies on its own cache line together with the cached copy of the other index, no lock is taken.
+A thread that finds the ring empty or full sleeps on an event counter of the other thread, which only wakes it if it is waiting.
+**/
+struct RingBuffer{
+    char *slots;              ///< numSlots slots of slotBytes bytes
+    size_t slotBytes;         ///< size of a slot in bytes
+    void *data;               ///< further memory the slots point to, e.g. the samples of the audio capture points, may be NULL
+    size_t numSlots;          ///< number of slots, a power of 2
+    size_t mask;              ///< numSlots-1, maps an index to its slot
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE))); ///< number of slots published by the producer
+    size_t cachedTail;        ///< released as last seen by the producer
+    int numOverruns;          ///< how often the producer found the ring full
+    int numDrops;             ///< number of unread slots the producer dropped to make room, see setRingDropOldest
+    long long startTime;      ///< monotonic nanoseconds at which the capture time of the slots is 0
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE))); ///< number of slots taken by the consumer or dropped by the producer
+    size_t released;          ///< number of slots whose memory the producer may reuse, tail without the slot the consumer holds
+    size_t cachedHead;        ///< head as last seen by the consumer
+    size_t claimed;           ///< index of the slot the consumer holds if the ring drops the oldest slots
+    int isClaimed;            ///< 1 while the consumer holds the slot claimed
+    int dropOldest;           ///< 1 if the producer drops the oldest unread slot instead of waiting while the ring is full
+    int numWakeups;           ///< how often the consumer was woken up by a published slot
+    double wakeupLatency;     ///< summed milliseconds from the wake up call to the running consumer
+    int headEvent __attribute__((aligned(CACHE_LINE_SIZE))); ///< counts the wake ups of the consumer, its futex
+    int tailEvent;            ///< counts the wake ups of the producer, its futex
+    int consumerWaiting;      ///< 1 while the consumer is about to sleep on headEvent
+    int producerWaiting;      ///< 1 while the producer is about to sleep on tailEvent
+    int closed;               ///< 1 after the producer published its last slot
+    long long wakeTime;       ///< monotonic nanoseconds of the last wake up of the consumer
+    char padding[CACHE_LINE_SIZE - 5 * sizeof(int) - sizeof(long long)]; ///< keeps the following data off the line of the events
+};
+typedef struct RingBuffer RingBuffer;///< use the data structure without the keyword struct
+
+/**
+@brief Bank of single bin analyzers that evaluates the spectrum only at the bins of the musical notes.
+Instead of the whole fft, only the bins of the 72 notes searched by getBins are calculated, optionally together with
+their neighbours. The goertzel analyzer runs one recurrence per bin over the windowed frame, the sliding-dft analyzer
+updates every bin with each new sample and applies cosine sum windows in the frequency domain.
+**/
+struct NoteBank{
+    int analyzer;   ///< NOTE_BANK_GOERTZEL or NOTE_BANK_SLIDING_DFT
+    int sampleSize; ///< the frame size, the bins are the ones of a fft of this size
+    int stepSize;   ///< number of new samples at the end of the frame for every call
+    int numBins;    ///< number of bins that are evaluated, in ascending order without duplicates
+    int *bins;      ///< fft bin index of every evaluated bin
+    int numOutputBins;  ///< number of bins that are written to the amplitude array
+    int *outputBins;    ///< fft bin index of every bin that is written to the amplitude array
+    int *binSlots;      ///< position of every fft bin in bins, -1 if the bin is not evaluated
+    double *coefficients;   ///< goertzel coefficient 2cos(2 pi k/N) of every evaluated bin
+    double *twiddleReal;    ///< real part of the sliding dft rotation e^(2 pi i k/N) of every evaluated bin
+    double *twiddleImag;    ///< imaginary part of the sliding dft rotation of every evaluated bin
+    double *stateReal;      ///< real part of the dft of the last sampleSize samples of every evaluated bin
+    double *stateImag;      ///< imaginary part of the dft of the last sampleSize samples of every evaluated bin
+    sample_t *window;       ///< window coefficients that the goertzel analyzer applies to the frame
+    int numWindowTerms;     ///< number of cosine terms of the window that the sliding dft applies per bin
+    double windowTerms[5];  ///< cosine sum coefficients a0 - a1 cos + a2 cos - ... of the window
+    sample_t *history;      ///< the last sampleSize samples seen by the sliding dft, used as ring buffer
+    int historyPos;         ///< position of the oldest sample in history
+    long samplesSinceSync;  ///< samples since the sliding dft was recomputed from history
+};
+typedef struct NoteBank NoteBank; ///< use the data structure without the keyword struct
+
+/**
+@brief Windowing functions that applyWindowingFunction can apply, resolved once from their names by getWindowingFunction.
+**/
+enum WindowingFunction{
+    WINDOW_RECTANGLE,           ///< rectangle, also used for unknown names
+    WINDOW_HANN,                ///< hann
+    WINDOW_HAMMING,             ///< hamming
+    WINDOW_TRIANGLE,            ///< triangle, bartlett, fejer
+    WINDOW_PARZEN,              ///< parzen
+    WINDOW_WELCH,               ///< welch
+    WINDOW_SINE,                ///< sine
+    WINDOW_BLACKMAN_ORIGINAL,   ///< blackman-original
+    WINDOW_BLACKMAN_EXACT,      ///< blackman-exact
+    WINDOW_NUTTALL,             ///< nuttall
+    WINDOW_BLACKMAN_NUTTALL,    ///< blackman-nuttall
+    WINDOW_BLACKMAN_HARRIS,     ///< blackman-harris
+    WINDOW_FLATTOP,             ///< flattop
+    WINDOW_RIFE_VINCENT,        ///< rife-vincent
+    WINDOW_GAUSS,               ///< gauss
+    WINDOW_GAUSS_CONFINED,      ///< gauss-confined
+    WINDOW_TUKEY,               ///< tukey
+    WINDOW_PLANK_TAPER,         ///< plank-taper
+    WINDOW_KAISER,              ///< kaiser
+    WINDOW_DOLPH_CHEBYSHEV,     ///< dolph-chebyshev
+    WINDOW_ULTRASPHERICAL,      ///< ultraspherical
+    WINDOW_SARAMAEKI,           ///< saramaeki
+    WINDOW_EXPONENTIAL,         ///< exponential, poisson
+    WINDOW_BARTLETT_HANN,       ///< bartlett-hann
+    WINDOW_HANN_POISSON,        ///< hann-poisson
+    WINDOW_LANCZOS,             ///< lanczos
+    NUM_WINDOWING_FUNCTIONS     ///< number of windowing functions
+};
+typedef enum WindowingFunction WindowingFunction; ///< use the enum without the keyword enum
+
+/**
+@brief Coefficients of one windowing function for one frame size.
+The coefficients only depend on the window, its shape parameter and the size and are shared by all frame loops.
+**/
+struct WindowCoefficients{
+    WindowingFunction windowingFunction; ///< window the coefficients were calculated for
+    double parameter;       ///< shape parameter of the window, beta of the kaiser window, 0 for the other windows
+    int sampleSize;         ///< number of coefficients
+    sample_t *coefficients; ///< the window, multiplied sample by sample with a frame
+    struct WindowCoefficients *next; ///< next window in the cache
+};
+typedef struct WindowCoefficients WindowCoefficients; ///< use the data structure without the keyword struct
+
+/**
+@brief History of the last samples of a frame loop and the window of its frames.
+Every sample is stored twice, at n and n+sampleSize, such that the frame always is the contiguous array history+historyPos.
+Adding the new samples of a hop therefore neither shifts the history nor wraps around.
 **/
-struct queue_node{
-  struct queue_node *next; ///< points to the following node in the queue
-  AudioCapturePoint *data; ///< data stored in this node
+struct FrameStager{
+    int sampleSize;         ///< size of the frames
+    int stepSize;           ///< number of new samples per hop
+    const sample_t *window; ///< cached coefficients of the window, see getWindowCoefficients
+    sample_t *history;      ///< 2*sampleSize samples, both halves hold the same ring buffer
+    int historyPos;         ///< position of the oldest sample of the frame
 };
+typedef struct FrameStager FrameStager; ///< use the data structure without the keyword struct
 
 /**
-@brief Queue that stores captured raw audio data together with their capture time.
-This data structure will be shared by the audio capture, as well as by the audio processing thread. Access to
-its property is handled over mutexes.
+@brief Loudest bin of the band of a spectrum and the power of its neighbours, the neighbours allow to interpolate between bins.
 **/
-struct AudioDataQueue{
-    struct queue_node *front; ///< points to the first node of the queue
-    struct queue_node *back; ///< points to the last node of the queue
-    size_t size; ///< how many elements there are in the queue
+struct SpectralPeak{
+    int bin;                ///< bin with the maximal power, 0 if no bin of the band is louder than a power of 1
+    sample_t power;         ///< power of the bin, 0 if no bin was found
+    sample_t lowerPower;    ///< power of the bin below, 0 at bin 0
+    sample_t upperPower;    ///< power of the bin above, 0 at bin sampleSize/2
 };
-typedef struct AudioDataQueue AudioDataQueue;///< use the data structure without the keyword struct
+typedef struct SpectralPeak SpectralPeak; ///< use the data structure without the keyword struct
 
 /**
-@brief This function initializes the queue data structure.
-@param queue points to the queue
+@brief Note of every bin of a fft, which replaces the search of the note of a frequency in the frame loops.
+The table only depends on its configuration and is shared by all frame loops with the same configuration.
 **/
-void initAudioDataQueue(AudioDataQueue *queue);
+struct NoteTable{
+    int sampleSize;         ///< sample size of the fft
+    double sampleRate;      ///< sample rate of the audio data
+    double tuningPitch;     ///< the reference frequency a4
+    double pitchResolution; ///< maximal difference in cents of a frequency to its note
+    int numBins;            ///< number of bins, sampleSize/2+1
+    float *notePositions;   ///< fractional midi note number of the frequency of every bin, 69 is the tuning pitch, 0 for bin 0
+    short *midiNotes;       ///< midi note of every bin, NO_MIDI_NOTE if the frequency of the bin is no note
+    float *cents;           ///< difference in cents of the frequency of every bin to the nearest note
+    int noteBins[NUM_NOTE_BINS]; ///< bin floor(f*sampleSize/sampleRate) of every note searched for chords, ascending
+    struct NoteTable *next; ///< next table in the cache
+};
+typedef struct NoteTable NoteTable; ///< use the data structure without the keyword struct
 
 /**
-@brief This function returns an empty queue structure.
-@return queue the created queue data structure
+@brief A note or a rest that the note tracker has finished.
 **/
-AudioDataQueue *queue_new(void);
+struct NoteEvent{
+    int midiNote;           ///< midi note number, NO_MIDI_NOTE for a rest
+    double frequency;       ///< frequency at the onset of the note
+    double onsetTime;       ///< time of the onset in milliseconds
+    double duration;        ///< duration in milliseconds
+};
+typedef struct NoteEvent NoteEvent; ///< use the data structure without the keyword struct
 
 /**
-@brief This function frees memory space occupied by the queue.
-@param queue points to queue
-@return isSuccess message whether succeeded or not
+@brief State machine that segments the midi notes of consecutive hops into notes and rests.
+A different note has to be detected for onsetHops consecutive hops before it replaces the current one, no note for offsetHops hops
+before the current note ends. Shorter deviations belong to the current note.
 **/
-int freeAudioDataQueue(AudioDataQueue *queue);
+struct NoteTracker{
+    int onsetHops;          ///< hops a different note has to last to start
+    int offsetHops;         ///< hops without a note that end the current note
+    int note;               ///< current midi note, NO_MIDI_NOTE during a rest
+    double frequency;       ///< frequency at the onset of the current note
+    double onsetTime;       ///< time of the onset of the current note
+    int candidateNote;      ///< midi note that differs from the current one
+    double candidateFrequency; ///< frequency at the first hop of the candidate
+    double candidateTime;   ///< time of the first hop of the candidate
+    int candidateHops;      ///< consecutive hops of the candidate
+};
+typedef struct NoteTracker NoteTracker; ///< use the data structure without the keyword struct
 
 /**
-@brief This function frees memory space occupied by the queue.
-@param queue points to queue
-@return isSuccess message whether succeeded or not
+@brief Sparse spectral kernel of one octave of a constant q transform.
+Every row holds the conjugated spectrum of a windowed complex atom, the entries below a threshold are dropped.
+The kernel only depends on the configuration and is shared by all transforms with the same configuration.
 **/
-int queue_destroy(AudioDataQueue *queue);
+struct ConstantQKernel{
+    double sampleRate;      ///< sample rate the kernel was calculated for
+    double minFrequency;    ///< center frequency of the lowest bin of the kernel
+    int binsPerOctave;      ///< number of bins of the octave
+    int fftLength;          ///< size of the fft that the kernel is applied to
+    int *rowStart;          ///< binsPerOctave+1 offsets, the entries of bin b are rowStart[b]..rowStart[b+1]-1
+    int *columns;           ///< fft bin of every kernel entry
+    sample_t *kernelReal;   ///< real part of every kernel entry
+    sample_t *kernelImag;   ///< imaginary part of every kernel entry
+    struct ConstantQKernel *next; ///< next kernel in the cache
+};
+typedef struct ConstantQKernel ConstantQKernel; ///< use the data structure without the keyword struct
 
 /**
-@brief This function checks whether the queue is empty.
-@param queue points to queue
-@return isSuccess message whether succeeded or not
+@brief Constant q transform of the frames of one frame loop.
+The kernel of the top octave is applied to the fft of the signal, the signal is then lowpassed and decimated by two for every lower octave,
+such that all octaves use the same kernel and fft size.
 **/
-int queue_empty(AudioDataQueue *queue);
+struct ConstantQTransform{
+    ConstantQKernel *kernel;    ///< the kernel of the top octave
+    struct fft_engine *fftEngine;   ///< the engine for the ffts of fftLength samples
+    int sampleSize;     ///< the frame size, the bins are written to the positions of a fft of this size
+    int stepSize;       ///< number of new samples at the end of the frame for every call
+    double sampleRate;  ///< sample rate of the audio data
+    int numOctaves;     ///< number of octaves, every octave is one decimation level
+    int binsPerOctave;  ///< 12 for semitone bins, 36 for third-tone bins
+    int numBins;        ///< numOctaves * binsPerOctave bins, ascending in frequency
+    double *frequencies;    ///< center frequency of every bin
+    sample_t *amplitudes;   ///< power of every bin in the scale of getPowerSpectrum
+    int *outputBins;        ///< position of every bin in the amplitude array of the frame loop
+    int *positionBins;      ///< bin that was written to every position of the amplitude array in the last frame, -1 for none
+    sample_t *history;      ///< the last fftLength samples of every decimation level, used as ring buffers
+    int *historyPos;        ///< position of the oldest sample in every ring buffer
+    double *decimationFilter;   ///< coefficients of the halfband lowpass in front of every decimation
+    double *delayLines;     ///< the last samples of every decimation level that are filtered, stored twice
+    int *delayPos;          ///< position of the oldest sample in every delay line
+    int *decimationPhase;   ///< every second filtered sample of a level is passed to the next level
+    sample_t *frame;        ///< the samples of one decimation level, oldest first
+    sample_t *real;         ///< real part of the fft of frame
+    sample_t *imag;         ///< imaginary part of the fft of frame
+};
+typedef struct ConstantQTransform ConstantQTransform; ///< use the data structure without the keyword struct
 
 /**
-@brief This function removes the element that was inserted into the queue at first.
-@param queue points to the queue
-@return audioCapturePoint the element stored at the front of queue
+@brief Analysis thread of a frame analysis pool together with its own analyzer and spectra.
 **/
-AudioCapturePoint *queue_dequeue(AudioDataQueue *queue);
+struct FrameAnalysisWorker{
+    struct FrameAnalysisPool *pool; ///< the pool of the thread
+    pthread_t thread;   ///< the thread
+    RingBuffer jobs;    ///< the frames queued for the thread, slots of a FrameJob and sampleSize samples
+    struct fft_engine *fftEngine;   ///< the engine for the ffts of the frames
+    NoteBank noteBank;              ///< the note bank of the goertzel and sliding-dft analyzers
+    ConstantQTransform constantQ;   ///< the transform of the constant-q analyzer
+    sample_t *amps;     ///< power of the sampleSize/2+1 bins of the note bank and constant q analyzers
+    sample_t *outReal;  ///< real part of the fft of the frame
+    sample_t *outImag;  ///< imaginary part of the fft of the frame
+    int numFrames;      ///< number of frames analyzed by the thread
+    double analysisTime;    ///< summed milliseconds the thread spent on the analysis of its frames
+    double fftTime;         ///< summed milliseconds of the ffts, note banks or constant q transforms
+};
+typedef struct FrameAnalysisWorker FrameAnalysisWorker;///< use the data structure without the keyword struct
 
 /**
-@brief This function insert an element into the queue.
-@param queue points to the queue.
-@param data element to be stored.
-@return isSuccess message whether succeeded or not
+@brief Pool of threads that analyze overlapping frames in parallel and return their spectral frames in the order of the hops.
+The hops are staged by the thread that submits them, which hands every frame to the analysis threads in turn. The threads write the
+spectral frames to the slot of the sequence number of their hop in a reorder buffer, from which the note tracking reads them in order.
+The sliding-dft and the constant-q analyzers carry their state from one hop to the next and are run by a single thread.
 **/
-int queue_enqueue(AudioDataQueue *queue, AudioCapturePoint *data);
+struct FrameAnalysisPool{
+    int numWorkers;     ///< number of analysis threads
+    FrameAnalysisWorker *workers;   ///< the analysis threads
+    ReorderBuffer results;  ///< the spectral frames of the hops in the order of their sequence numbers
+    FrameStager stager;     ///< the history of the hops, only used by the submitting thread
+    int sampleSize;     ///< the frame size
+    double sampleRate;  ///< sample rate of the audio data
+    int minBin;         ///< lowest bin of the band of the peak search
+    int maxBin;         ///< highest bin of the band of the peak search
+    int useNoteBank;    ///< 1 for the goertzel and sliding-dft analyzers
+    int useConstantQ;   ///< 1 for the constant-q analyzer
+    int interpolatePeak;    ///< 1 if the frequency of the fft peak is interpolated between the bins
+    int isStarted;      ///< 1 while the analysis threads run
+    double stagingTime; ///< summed milliseconds the submitting thread spent on staging the frames
+};
+typedef struct FrameAnalysisPool FrameAnalysisPool;///< use the data structure without the keyword struct
 
 /**
 @brief WAVE file header format
@@ -255,6 +526,15 @@ struct RunTimeInformation{
   int buffSize;
   int numBins;
   char *windowingFunction;
+  double kaiserBeta;
+  char *fftEngine;
+  char *spectralAnalyzer;
+  char *backpressurePolicy;
+  int noteBankNeighbours;
+  int constantQBinsPerOctave;
+  int peakInterpolation;
+  int pinPipelineThreads;
+  int frameAnalysisWorkers;
   int beatsPerMinute;
 
   int quit;
@@ -0,0 +1,11 @@
+/**
+@file fft_builtin.h
+@author Lukas Graber
+@date 30 May 2019
+@brief The fft engine that runs the transforms of FFT.c.
+**/
+#ifndef FFT_BUILTIN_H
+#define FFT_BUILTIN_H
+#include "fft_engine.h"
+int open_builtin_fft(struct fft_engine **, int);
+#endif
@@ -0,0 +1,54 @@
+/**
+@file fft_engine.h
+The engines share the interface of struct pcm: a table of function pointers and a pointer to the data
+of the backend. An engine is opened once for a transform size and then runs every frame of that size.
+@author Lukas Graber
+@date 30 May 2019
+@brief Interface of the exchangeable fft engines.
+**/
+#ifndef FFT_ENGINE_H
+#define FFT_ENGINE_H
+#include "ApplicationMacros.h"
+
+struct fft_engine {
+	void (*close)(struct fft_engine *);
+	const char *(*name)(struct fft_engine *);
+	int (*size)(struct fft_engine *);
+	int (*forward)(struct fft_engine *, const sample_t *, sample_t *, sample_t *);
+	sample_t *(*input)(struct fft_engine *);
+	void *data;
+};
+
+void close_fft_engine(struct fft_engine *);
+const char *name_fft_engine(struct fft_engine *);
+int size_fft_engine(struct fft_engine *);
+
+/**
+@brief This function returns the input buffer of an engine.
+A frame that is written directly to this buffer and passed to forward_fft_engine is not copied again by the engine.
+@param engine the engine
+@return input buffer of size samples, owned by the engine
+**/
+sample_t *input_fft_engine(struct fft_engine *);
+
+/**
+@brief This function runs the fft of one frame of real samples.
+@param engine engine opened for the size of the frame
+@param input the real samples of the frame
+@param outReal real part of the spectrum, needs space for size/2+1 values
+@param outImag imaginary part of the spectrum, needs space for size/2+1 values
+@return isSuccess 0 if the transform failed
+**/
+int forward_fft_engine(struct fft_engine *, const sample_t *, sample_t *, sample_t *);
+
+/**
+@brief This function opens an fft engine by its name.
+Available engines are "builtin" (FFT.c) and "fftw" (FFTW3 in single precision).
+@param engine pointer that receives the opened engine
+@param name name of the engine
+@param size size of the transform
+@return isSuccess 0 if the engine does not exist or can not be opened for the size
+**/
+int open_fft_engine(struct fft_engine **, const char *, int);
+
+#endif
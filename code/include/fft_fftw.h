@@ -0,0 +1,11 @@
+/**
+@file fft_fftw.h
+@author Lukas Graber
+@date 30 May 2019
+@brief The fft engine that runs the transforms with FFTW3 in single precision.
+**/
+#ifndef FFT_FFTW_H
+#define FFT_FFTW_H
+#include "fft_engine.h"
+int open_fftw_fft(struct fft_engine **, int);
+#endif
@@ -12,18 +12,40 @@ The file mainly contains functions to implement windowing funcitonality.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "../include/ApplicationMacros.h"
 #include "../include/AudioPreProcessing.h"
 #include "../include/HelperFunctions.h"
+#include "../include/CpuFeatures.h"
+#include "../include/FFT.h"
+#include "../include/fft_engine.h"
+
+#define CONSTANT_Q_NUM_OCTAVES 6        ///< octaves of the constant q transform, the same as in getBins
+#define CONSTANT_Q_FILTER_TAPS 31       ///< length of the halfband lowpass in front of every decimation
+#define CONSTANT_Q_THRESHOLD 0.0054     ///< kernel entries below this fraction of the largest entry of their bin are dropped
+
+static ConstantQKernel *constantQKernels = NULL;    ///< kernels of all configurations used so far
+static pthread_mutex_t constantQKernelMutex = PTHREAD_MUTEX_INITIALIZER; ///< protects the kernel cache
+static WindowCoefficients *windowCoefficients = NULL;   ///< coefficients of all windows and sizes used so far
+static pthread_mutex_t windowCoefficientsMutex = PTHREAD_MUTEX_INITIALIZER; ///< protects the window cache
 
 /**
 The function will calculate the power level/ amplitude of the fft data in each bin. It puts the data in logarithmic scale back to the array.
+The spectrum of real audio data is symmetric, that is why only the sampleSize/2+1 non-redundant bins are calculated.
 **/
-void getFrequencySpectrum(double *amps, double *real, double *imag, int sampleSize){
-    for(int i = 0; i < sampleSize; i++){
-        double magnitude = sqrt(real[i]*real[i] + imag[i]*imag[i]);
-        double amplitude = 10 * log10(magnitude);
+void getFrequencySpectrum(sample_t *amps, sample_t *real, sample_t *imag, int sampleSize){
+    for(int i = 0; i <= sampleSize/2; i++){
+        sample_t magnitude = SAMPLE_SQRT(real[i]*real[i] + imag[i]*imag[i]);
+        sample_t amplitude = 10 * SAMPLE_LOG10(magnitude);
         amps[i] = amplitude;
     }
 }
@@ -60,18 +82,25 @@ int faculty(int x){
 }
 
 /**
+Every term of the series is calculated from the previous one, (x/2)^(2k+order)/(k!(k+order)!) would overflow
+the factorials long before the series converges.
 **/
 double besselFunctionFirstKind(int order,double x){
-    int numIterations = 1000;
-    double sum = 0;
-    double numerator = 0;
-    double denominator = 0;
-    for(int k = 0; k < numIterations; k++){
-        numerator = pow((0.25*pow(x,2.0)),k);
-        denominator = faculty(k)*faculty(order+k);
-        sum = sum + (numerator/denominator);
+    int maxIterations = 1000;
+    double quarterSquare = 0.25*x*x;
+    double term = 1.0;
+    for(int k = 1; k <= order; k++){
+        term = term * 0.5*x / k;
     }
-    return pow(0.5*x,order);
+    double sum = term;
+    for(int k = 1; k < maxIterations; k++){
+        term = term * quarterSquare / ((double)k*(k+order));
+        if(sum + term == sum){
+            break;
+        }
+        sum = sum + term;
+    }
+    return sum;
 }
 
 /**
@@ -95,35 +124,102 @@ double getDolphChebyshevNumber(double alpha, double beta, double n, int N, int k
 }
 
 /**
+The three-term recurrence runs upwards from the polynomials of degree 0 and 1, every degree is calculated once.
 **/
 double gegenBauerPolynomial(int n,double alpha,double x){
+    double previous = 1;
+    double polynomial = 2*alpha*x;
     if(n == 0){
-        return 1;
-    }else if(n == 1){
-        return 2*alpha*x;
-    }else{
-        return (1/n) * (2*x*(n+alpha-1)*gegenBauerPolynomial(n-1,alpha,x)-(n+2*alpha-2)*gegenBauerPolynomial(n-2,alpha,x));
+        return previous;
+    }
+    for(int k = 2; k <= n; k++){
+        double next = (2*x*(k+alpha-1)*polynomial - (k+2*alpha-2)*previous) / k;
+        previous = polynomial;
+        polynomial = next;
+    }
+    return polynomial;
+}
+
+/**
+Unknown names select the rectangle window, such that the frame passes unchanged as before.
+**/
+WindowingFunction getWindowingFunction(char *windowingFunctionName){
+    if(strcmp(windowingFunctionName, "hann")==0){
+        return WINDOW_HANN;
+    }else if(strcmp(windowingFunctionName, "hamming")==0){
+        return WINDOW_HAMMING;
+    }else if(strcmp(windowingFunctionName, "triangle")==0 || strcmp(windowingFunctionName, "bartlett")==0 || strcmp(windowingFunctionName, "fejer")==0){
+        return WINDOW_TRIANGLE;
+    }else if(strcmp(windowingFunctionName, "parzen")==0){
+        return WINDOW_PARZEN;
+    }else if(strcmp(windowingFunctionName, "welch")==0){
+        return WINDOW_WELCH;
+    }else if(strcmp(windowingFunctionName, "sine")==0){
+        return WINDOW_SINE;
+    }else if(strcmp(windowingFunctionName, "blackman-original")==0){
+        return WINDOW_BLACKMAN_ORIGINAL;
+    }else if(strcmp(windowingFunctionName, "blackman-exact")==0){
+        return WINDOW_BLACKMAN_EXACT;
+    }else if(strcmp(windowingFunctionName, "nuttall")==0){
+        return WINDOW_NUTTALL;
+    }else if(strcmp(windowingFunctionName, "blackman-nuttall")==0){
+        return WINDOW_BLACKMAN_NUTTALL;
+    }else if(strcmp(windowingFunctionName, "blackman-harris")==0){
+        return WINDOW_BLACKMAN_HARRIS;
+    }else if(strcmp(windowingFunctionName, "flattop")==0){
+        return WINDOW_FLATTOP;
+    }else if(strcmp(windowingFunctionName, "rife-vincent")==0){
+        return WINDOW_RIFE_VINCENT;
+    }else if(strcmp(windowingFunctionName, "gauss")==0){
+        return WINDOW_GAUSS;
+    }else if(strcmp(windowingFunctionName, "gauss-confined")==0){
+        return WINDOW_GAUSS_CONFINED;
+    }else if(strcmp(windowingFunctionName, "tukey")==0){
+        return WINDOW_TUKEY;
+    }else if(strcmp(windowingFunctionName, "plank-taper")==0){
+        return WINDOW_PLANK_TAPER;
+    }else if(strcmp(windowingFunctionName, "kaiser")==0){
+        return WINDOW_KAISER;
+    }else if(strcmp(windowingFunctionName, "dolph-chebyshev")==0){
+        return WINDOW_DOLPH_CHEBYSHEV;
+    }else if(strcmp(windowingFunctionName, "ultraspherical")==0){
+        return WINDOW_ULTRASPHERICAL;
+    }else if(strcmp(windowingFunctionName, "saramaeki")==0){
+        return WINDOW_SARAMAEKI;
+    }else if(strcmp(windowingFunctionName, "exponential")==0 || strcmp(windowingFunctionName, "poisson")==0){
+        return WINDOW_EXPONENTIAL;
+    }else if(strcmp(windowingFunctionName, "bartlett-hann")==0){
+        return WINDOW_BARTLETT_HANN;
+    }else if(strcmp(windowingFunctionName, "hann-poisson")==0){
+        return WINDOW_HANN_POISSON;
+    }else if(strcmp(windowingFunctionName, "lanczos")==0){
+        return WINDOW_LANCZOS;
     }
+    return WINDOW_RECTANGLE;
 }
 
 /**
-The windowingFunctionName selects a specific windowing function. This function will be run on every bin in the audioData array.
+The coefficients are calculated in double precision and rounded to sample_t. A window that has no formula for some n
+keeps the coefficient of the previous n, exactly as the frames were windowed before the coefficients were cached.
 @see https://en.wikipedia.org/wiki/Window_function
 **/
-void applyWindowingFunction(double *audioData, int sampleSize, char *windowingFunctionName){
+static void calculateWindowCoefficients(sample_t *coefficients, WindowingFunction windowingFunction, int sampleSize){
     double windowCoefficient = 1.0;
     int N = sampleSize;
     for(int n = 0; n < N; n++){
-        if(strcmp(windowingFunctionName, "rectangle")==0){
-            windowCoefficient = 1.0;
-        }else if(strcmp(windowingFunctionName, "hann")==0){
+        switch(windowingFunction){
+        case WINDOW_HANN:
             windowCoefficient = 0.5 - 0.5 * cos((2 * M_PI * n)/N);
-        }else if(strcmp(windowingFunctionName, "hamming")==0){
+            break;
+        case WINDOW_HAMMING:
             windowCoefficient = 0.54 - 0.46 * cos((2 * M_PI * n)/N);
-        }else if(strcmp(windowingFunctionName, "triangle")==0 || strcmp(windowingFunctionName, "bartlett")==0 || strcmp(windowingFunctionName, "fejer")==0){ //B-Spline Window
+            break;
+        case WINDOW_TRIANGLE:{ //B-Spline Window
             int L = N; //can also be N+1 or N+2
             windowCoefficient = 1 - fabs((n-L/2)/(L/2));
-        }else if(strcmp(windowingFunctionName, "parzen")==0){
+            break;
+        }
+        case WINDOW_PARZEN:{
             int L = N+1;
             double cofactor = 0;
             if((0 <= fabs(n-L/2) && fabs(n-L/2) <= L/4)){
@@ -132,58 +228,79 @@ void applyWindowingFunction(double *audioData, int sampleSize, char *windowingFu
                 cofactor = 2*pow((1-(abs(n)/(L/2))),3.0);
             }
             windowCoefficient = cofactor * (n-N/2);
-        }else if(strcmp(windowingFunctionName, "welch")==0){
+            break;
+        }
+        case WINDOW_WELCH:
             windowCoefficient = 1- pow(((n-N/2)/(N/2)),2.0);
-        }else if(strcmp(windowingFunctionName, "sine")==0){
+            break;
+        case WINDOW_SINE:
             windowCoefficient = sin(M_PI * n/N);
-        }else if(strcmp(windowingFunctionName, "blackman-original")==0){
+            break;
+        case WINDOW_BLACKMAN_ORIGINAL:{
             double a = 0.16;
             double a0 = (1-a)/2;
             double a1 = 1/2;
             double a2 = a/2;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "blackman-exact")==0){
+            break;
+        }
+        case WINDOW_BLACKMAN_EXACT:{
             double a0 = 7938.0/18608.0;
             double a1 = 9240.0/18608.0;
             double a2 = 1430.0/18608.0;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "nuttall")==0){
+            break;
+        }
+        case WINDOW_NUTTALL:{
             double a0 = 0.355768;
             double a1 = 0.487396;
             double a2 = 0.144232;
             double a3 = 0.012604;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N) - a3 * cos(6*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "blackman-nuttall")==0){
+            break;
+        }
+        case WINDOW_BLACKMAN_NUTTALL:{
             double a0 = 0.3635819;
             double a1 = 0.4891775;
             double a2 = 0.1365995;
             double a3 = 0.0106411;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N) - a3 * cos(6*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "blackman-harris")==0){
+            break;
+        }
+        case WINDOW_BLACKMAN_HARRIS:{
             double a0 = 0.35875;
             double a1 = 0.48829;
             double a2 = 0.14128;
             double a3 = 0.01168;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N) - a3 * cos(6*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "flattop")==0){
+            break;
+        }
+        case WINDOW_FLATTOP:{
             double a0 = 0.21557895;
             double a1 = 0.41663158;
             double a2 = 0.277263158;
             double a3 = 0.083578947;
             double a4 = 0.006947368;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N) - a3 * cos(6*M_PI*n/N) + a4 * cos(8*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "rife-vincent")==0){
+            break;
+        }
+        case WINDOW_RIFE_VINCENT:{
             double a0 = 1.0;
             double a1 = 4.0/3.0;
             double a2 = 1.0/3.0;
             windowCoefficient = a0 - a1 * cos(2*M_PI*n/N) + a2 * cos(4*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "gauss")==0){
+            break;
+        }
+        case WINDOW_GAUSS:{
             double sigma = 0.5;
             double exponent = -0.5 * pow(((n-N/2)/(sigma*N/2)),2.0);
             windowCoefficient = pow(M_E,exponent);
-        }else if(strcmp(windowingFunctionName, "gauss-confined")==0){
+            break;
+        }
+        case WINDOW_GAUSS_CONFINED:
             windowCoefficient = getGaussianNumber(n,N) - (getGaussianNumber(-0.5,N)*(getGaussianNumber(n+N+1,N) + getGaussianNumber(n-N-1,N)))/(getGaussianNumber(0.5+N,N) + getGaussianNumber(-1.5-N,N));
-        }else if(strcmp(windowingFunctionName, "tukey")==0){
+            break;
+        case WINDOW_TUKEY:{
             double alpha = 0.5; //can be chosen freely
             if(0 <= n && n < (alpha*N/2)){
                 windowCoefficient = 0.5 * (1+cos(M_PI * ((2*n/(alpha*N))-1)));
@@ -192,7 +309,9 @@ void applyWindowingFunction(double *audioData, int sampleSize, char *windowingFu
             }else if((N*(1-alpha/2)) < n && n <= N){
                 windowCoefficient = 0.5 * (1+cos(M_PI * ((2*n/(alpha*N))-(2/alpha)+1)));
             }
-        }else if(strcmp(windowingFunctionName, "plank-taper")==0){
+            break;
+        }
+        case WINDOW_PLANK_TAPER:{
             double epsilon = 0.1;
             if(0 <= n && n <= (epsilon * N)){
                 windowCoefficient = 1/(getPositivePlankNumber(epsilon,n,N));
@@ -203,81 +322,308 @@ void applyWindowingFunction(double *audioData, int sampleSize, char *windowingFu
             }else{
                 windowCoefficient = 0;
             }
-        }else if(strcmp(windowingFunctionName, "kaiser")==0){
-            double alpha = 3.0;
-            double numerator = besselFunctionFirstKind(0,M_PI * alpha *sqrt(1-pow(2*n/N-1,2.0)));
-            double denominator = besselFunctionFirstKind(0,M_PI*alpha);
-            windowCoefficient = numerator/denominator;
-        }else if(strcmp(windowingFunctionName, "dolph-chebyshev")==0){
-            double alpha = 5.0;
-            double beta = cosh((1/N)* acosh(pow(10,alpha)));
-            double sum = 0;
-            for(int k = 0; k < N; k++){
-                sum = sum + getDolphChebyshevNumber(alpha,beta,n,N,k) * pow(M_E,2*M_PI*k*(n-N/2)/(N+1));
-            }
-            double cofactor = 1/(N+1)* sum;
-            windowCoefficient = cofactor * (n-N/2);
-        }else if(strcmp(windowingFunctionName, "ultraspherical")==0){
-            double mu = -0.5;
-            double x0 = 1.0;
-            double sum = 0;
-            for(int k = 1; k<=N/2;k++){
-                sum = sum + gegenBauerPolynomial(N,mu,x0*cos(k*M_PI/(N+1))) * cos(2*n*M_PI*k/(N+1));
-            }
-            windowCoefficient = 1/(N+1) * (gegenBauerPolynomial(N,mu,x0)+sum);
-        }else if(strcmp(windowingFunctionName, "saramaeki")==0){
-            double mu = 1.0;
-            double x0 = 1.0;
-            double sum = 0;
-            for(int k = 1; k<=N/2;k++){
-                sum = sum + gegenBauerPolynomial(N,mu,x0*cos(k*M_PI/(N+1))) * cos(2*n*M_PI*k/(N+1));
-            }
-            windowCoefficient = 1/(N+1) * (gegenBauerPolynomial(N,mu,x0)+sum);
-        }else if(strcmp(windowingFunctionName, "exponential")==0 || strcmp(windowingFunctionName, "poisson")==0){
+            break;
+        }
+        case WINDOW_EXPONENTIAL:{
             double decayOfdB = 1;
             double tau = (N/2) * (8.69/decayOfdB);
             windowCoefficient = pow(M_E,-fabs(n-N/2)*(1/tau));
-        }else if(strcmp(windowingFunctionName, "bartlett-hann")==0){
+            break;
+        }
+        case WINDOW_BARTLETT_HANN:{
             double a0 = 0.62;
             double a1 = 0.48;
             double a2 = 0.38;
             windowCoefficient = a0 - a1 * fabs(n/N-0.5) - a2 * cos(2*M_PI*n/N);
-        }else if(strcmp(windowingFunctionName, "hann-poisson")==0){
+            break;
+        }
+        case WINDOW_HANN_POISSON:{
             double alpha = 2.0;
             windowCoefficient = 0.5 * (1-cos(2*M_PI*n/N)) * pow(M_E,(-alpha * fabs(N-2*n))/N);
-        }else if(strcmp(windowingFunctionName, "lanczos")==0){
+            break;
+        }
+        case WINDOW_LANCZOS:
             windowCoefficient = sin(M_PI * ((2*n/N)-1))/(M_PI*((2*n/N)-1));
-        }else{
+            break;
+        default:
             windowCoefficient = 1.0;
+            break;
         }
-        audioData[n] = audioData[n] * windowCoefficient;
+        coefficients[n] = windowCoefficient;
+    }
+}
+
+/**
+The polynomial of the saramaeki window is the chebyshev polynomial of the second kind, which has a closed form like
+getChebyshevPolynomial.
+**/
+static double getSaramaekiNumber(double x, int n){
+    if(fabs(x) < 1){
+        return sin((n+1)*acos(x))/sqrt(1-x*x);
+    }else if(x > 1){
+        return sinh((n+1)*acosh(x))/sqrt(x*x-1);
+    }else if(x < -1){
+        return (n % 2 == 0 ? 1 : -1) * sinh((n+1)*acosh(-x))/sqrt(x*x-1);
     }
+    return x > 0 || n % 2 == 0 ? n+1 : -(n+1);
+}
+
+/**
+The dolph-chebyshev and ultraspherical windows are defined by samples of their spectrum, W(k) = P(x0*cos(pi*k/M))
+with a polynomial P of degree M-1 for the symmetric window of M = N+1 samples: the chebyshev polynomial, the gegenbauer
+polynomial with mu = -0.5 and the one with mu = 1 for the saramaeki window. x0 places the side lobes of the chebyshev
+polynomial 10^alpha below the main lobe and is used for the other polynomials as well. The inverse fft of the spectrum,
+delayed by (M-1)/2 samples such that the peak is in the center, is the window, normalized to a peak of 1. Its last sample
+is dropped, as the other windows are periodic with period N.
+The chebyshev and saramaeki spectra have closed forms, the whole window takes O(N log N). The gegenbauer polynomial of the
+ultraspherical window has none, its recurrence runs for all samples at once, as W(M-k) = (-1)^(M-1) W(k) for the first half only.
+**/
+static void calculateSpectralWindowCoefficients(sample_t *coefficients, WindowingFunction windowingFunction, int sampleSize){
+    int M = sampleSize + 1;
+    int order = M - 1;
+    int half = M/2 + 1;
+    double alpha = 5.0;
+    double x0 = cosh(acosh(pow(10,alpha))/order);
+    double *real = (double *)malloc(M * sizeof(double));
+    double *imag = (double *)malloc(M * sizeof(double));
+    for(int k = 0; k < half; k++){
+        imag[k] = x0 * cos(M_PI * k / M);
+        if(windowingFunction == WINDOW_DOLPH_CHEBYSHEV){
+            real[k] = getChebyshevPolynomial(imag[k],order);
+        }else if(windowingFunction == WINDOW_SARAMAEKI){
+            real[k] = getSaramaekiNumber(imag[k],order);
+        }else{
+            real[k] = 1;
+        }
+    }
+    if(windowingFunction == WINDOW_ULTRASPHERICAL){
+        // gegenBauerPolynomial for all x at once, the imaginary part holds x until the phase is applied
+        double mu = -0.5;
+        double *x = imag;
+        double *polynomial = real;
+        double *previous = (double *)malloc(half * sizeof(double));
+        for(int k = 0; k < half; k++){
+            previous[k] = 1;
+            polynomial[k] = 2*mu*x[k];
+        }
+        for(int degree = 2; degree <= order; degree++){
+            double a = 2*(degree+mu-1)/degree;
+            double b = (degree+2*mu-2)/degree;
+            for(int k = 0; k < half; k++){
+                double next = a*x[k]*polynomial[k] - b*previous[k];
+                previous[k] = polynomial[k];
+                polynomial[k] = next;
+            }
+        }
+        free(previous);
+    }
+    for(int k = half; k < M; k++){
+        real[k] = order % 2 == 0 ? real[M-k] : -real[M-k];
+    }
+    for(int k = 0; k < M; k++){
+        // the delay is a phase of -pi*k*(M-1)/M, reduced to one period before it is scaled
+        double phase = -M_PI * (double)(((long long)k * (M-1)) % (2*M)) / M;
+        imag[k] = real[k] * sin(phase);
+        real[k] = real[k] * cos(phase);
+    }
+    Fft_inverseTransform(real, imag, M);
+    double peak = real[0];
+    for(int n = 0; n < sampleSize; n++){
+        peak = fabs(real[n]) > fabs(peak) ? real[n] : peak;
+    }
+    for(int n = 0; n < sampleSize; n++){
+        coefficients[n] = real[n] / peak;
+    }
+    free(real);
+    free(imag);
+}
+
+/**
+I0(beta) is the same for every n and only calculated once, the argument of the numerator stays in 0..beta.
+**/
+static void calculateKaiserCoefficients(sample_t *coefficients, double beta, int sampleSize){
+    int N = sampleSize;
+    double denominator = besselFunctionFirstKind(0,beta);
+    for(int n = 0; n < N; n++){
+        double x = 2.0*n/N - 1;
+        coefficients[n] = besselFunctionFirstKind(0,beta * sqrt(1 - x*x)) / denominator;
+    }
+}
+
+/**
+The cache is shared by all threads, the coefficients are never changed after they were calculated.
+**/
+static const sample_t *lookupWindowCoefficients(WindowingFunction windowingFunction, double parameter, int sampleSize){
+    pthread_mutex_lock(&windowCoefficientsMutex);
+    WindowCoefficients *window = windowCoefficients;
+    while (window != NULL && (window->windowingFunction != windowingFunction || window->parameter != parameter || window->sampleSize != sampleSize)) {
+        window = window->next;
+    }
+    if (window == NULL) {
+        window = (WindowCoefficients *)calloc(1,sizeof(WindowCoefficients));
+        window->windowingFunction = windowingFunction;
+        window->parameter = parameter;
+        window->sampleSize = sampleSize;
+        window->coefficients = (sample_t *)malloc(sampleSize * sizeof(sample_t));
+        if (windowingFunction == WINDOW_KAISER) {
+            calculateKaiserCoefficients(window->coefficients, parameter, sampleSize);
+        } else if (windowingFunction == WINDOW_DOLPH_CHEBYSHEV || windowingFunction == WINDOW_ULTRASPHERICAL || windowingFunction == WINDOW_SARAMAEKI) {
+            calculateSpectralWindowCoefficients(window->coefficients, windowingFunction, sampleSize);
+        } else {
+            calculateWindowCoefficients(window->coefficients, windowingFunction, sampleSize);
+        }
+        window->next = windowCoefficients;
+        windowCoefficients = window;
+    }
+    pthread_mutex_unlock(&windowCoefficientsMutex);
+    return window->coefficients;
+}
+
+const sample_t *getWindowCoefficients(WindowingFunction windowingFunction, int sampleSize, double kaiserBeta){
+    return lookupWindowCoefficients(windowingFunction, windowingFunction == WINDOW_KAISER ? kaiserBeta : 0, sampleSize);
+}
+
+void freeWindowCoefficients(void){
+    pthread_mutex_lock(&windowCoefficientsMutex);
+    while (windowCoefficients != NULL) {
+        WindowCoefficients *next = windowCoefficients->next;
+        free(windowCoefficients->coefficients);
+        free(windowCoefficients);
+        windowCoefficients = next;
+    }
+    pthread_mutex_unlock(&windowCoefficientsMutex);
+}
+
+/**
+The loop has no branches and no calls, such that the compiler vectorizes it.
+**/
+void applyWindowCoefficients(sample_t *restrict audioData, const sample_t *restrict coefficients, int sampleSize){
+    for(int n = 0; n < sampleSize; n++){
+        audioData[n] *= coefficients[n];
+    }
+}
+
+void initFrameStager(FrameStager *stager, int sampleSize, int stepSize, WindowingFunction windowingFunction, double kaiserBeta){
+    stager->sampleSize = sampleSize;
+    stager->stepSize = stepSize;
+    stager->window = getWindowCoefficients(windowingFunction, sampleSize, kaiserBeta);
+    stager->history = (sample_t *)calloc(2 * sampleSize, sizeof(sample_t));
+    stager->historyPos = 0;
+}
+
+/**
+The old part of the frame is read from the history, the new part directly from the samples. The new samples then replace
+the oldest ones in both halves of the history, these are not part of the current frame.
+The loops have no branches and are vectorized by the compiler.
+**/
+const sample_t *stageFrame(FrameStager *stager, const short *restrict samples, sample_t *restrict frame){
+    int N = stager->sampleSize;
+    int step = stager->stepSize;
+    int pos = stager->historyPos;
+    const sample_t scale = 1.0f / 32768.0f;
+    if (frame != NULL) {
+        const sample_t *restrict window = stager->window;
+        const sample_t *restrict old = stager->history + pos + step;
+        for (int n = 0; n < N - step; n++) {
+            frame[n] = old[n] * window[n];
+        }
+        for (int i = 0; i < step; i++) {
+            frame[N - step + i] = ((sample_t)samples[i] * scale) * window[N - step + i];
+        }
+    }
+
+    // The oldest samples are at pos..pos+step-1, split where the ring wraps around
+    sample_t *restrict lower = stager->history;
+    sample_t *restrict upper = stager->history + N;
+    int first = step < N - pos ? step : N - pos;
+    for (int i = 0; i < first; i++) {
+        lower[pos + i] = upper[pos + i] = (sample_t)samples[i] * scale;
+    }
+    for (int i = first; i < step; i++) {
+        lower[pos + i - N] = upper[pos + i - N] = (sample_t)samples[i] * scale;
+    }
+    stager->historyPos = (pos + step) % N;
+    return stager->history + stager->historyPos;
+}
+
+void resetFrameStager(FrameStager *stager){
+    memset(stager->history, 0, 2 * stager->sampleSize * sizeof(sample_t));
+    stager->historyPos = 0;
+}
+
+void freeFrameStager(FrameStager *stager){
+    free(stager->history);
+    stager->history = NULL;
+}
+
+/**
+The loop has no branches and no calls, such that the compiler vectorizes it.
+**/
+void getPowerSpectrum(sample_t *restrict power, const sample_t *restrict real, const sample_t *restrict imag, int minBin, int maxBin){
+    for(int i = minBin; i < maxBin; i++){
+        power[i] = real[i]*real[i] + imag[i]*imag[i];
+    }
+}
+
+/**
+10*log10(sqrt(p)) = 5*log10(2)*log2(p). log2 of the float p is its exponent plus log2 of its mantissa m in [1,2), which is
+approximated by a polynomial of degree 5 in m-1 with an error below 1.5e-5. The power 0 maps to about -190 instead of -inf.
+The exponent and the mantissa are taken from the bits of p, the loop has no branches and no calls and is vectorized by the compiler.
+**/
+void getLogarithmicSpectrum(sample_t *amps, const sample_t *power, int numBins){
+    const float scale = 1.50514997831990598f; // 5*log10(2)
+    for(int i = 0; i < numBins; i++){
+        float p = (float)power[i];
+        uint32_t bits;
+        memcpy(&bits, &p, sizeof(bits));
+        float exponent = (float)((int32_t)(bits >> 23) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+        float mantissa;
+        memcpy(&mantissa, &bits, sizeof(mantissa));
+        float t = mantissa - 1.0f;
+        float logMantissa = t * (1.44196614f + t * (-0.709668957f + t * (0.417617608f + t * (-0.196299523f + t * 0.0463992231f))));
+        amps[i] = (sample_t)(scale * (exponent + logMantissa));
+    }
+}
+
+void getBandpassBins(int *minBin, int *maxBin, int sampleSize, double sampleRate, double lowFrequency, double highFrequency){
+    *minBin = (int)(lowFrequency * sampleSize / sampleRate);
+    *maxBin = (int)(highFrequency * sampleSize / sampleRate);
+    *maxBin = *maxBin > sampleSize/2 + 1 ? sampleSize/2 + 1 : *maxBin;
+    *minBin = *minBin > *maxBin ? *maxBin : *minBin;
+}
+
+/**
+The window is looked up by its name in the cache for every call, frame loops resolve it once with getWindowCoefficients instead.
+**/
+void applyWindowingFunction(sample_t *audioData, int sampleSize, char *windowingFunctionName){
+    applyWindowCoefficients(audioData, getWindowCoefficients(getWindowingFunction(windowingFunctionName), sampleSize, KAISER_BETA), sampleSize);
 }
 
 /**
 In the ApplicatinoMacros.h file, you can specify the low and high frequency. The idea is that you can narrow down
 the frequency region for which the human ear is perceptible.
 **/
-void applyFrequencyBandpass(double *amps, int sampleSize, int sampleRate, double lowFrequency, double highFrequency){
-    int minBin = (int)(lowFrequency * sampleSize / sampleRate);
-    int maxBin = (int)(highFrequency * sampleSize / sampleRate);
+void applyFrequencyBandpass(sample_t *amps, int sampleSize, int sampleRate, double lowFrequency, double highFrequency){
+    int minBin, maxBin;
+    getBandpassBins(&minBin, &maxBin, sampleSize, sampleRate, lowFrequency, highFrequency);
     for(int i = 0; i < minBin;i++){
         amps[i] = 0;
     }
-    for(int i = maxBin; i < sampleSize; i++){
+    for(int i = maxBin; i <= sampleSize/2; i++){
         amps[i] = 0;
     }
 }
 
 /**
 The function iterates over the amps array and keeps track which bin has the highest amplitude. At the end
-the index of this bin will be returned.
+the index of this bin will be returned. A power of 1 is the amplitude 0 of the logarithmic scale of getFrequencySpectrum.
 **/
-int getFrequencyBin(double *amps, int sampleSize){
-    double maxAmp = 0;
+int getFrequencyBin(sample_t *amps, int sampleSize){
+    sample_t maxAmp = 1;
     int maxInd = 0;
-    for(int i = 0; i < sampleSize; i++){
-        double amplitude = amps[i];
+    for(int i = 0; i <= sampleSize/2; i++){
+        sample_t amplitude = amps[i];
         if(amplitude > maxAmp){
             maxAmp = amplitude;
             maxInd = i;
@@ -285,3 +631,414 @@ int getFrequencyBin(double *amps, int sampleSize){
     }
     return maxInd;
 }
+
+/*
+ * Generates a vectorized peak search over the bins minBin.. of the band. Every lane keeps the maximal power of its bins and the bin,
+ * the bins are counted in sample_t, which holds them exactly. selectGreater(x, y, a, b) returns a where x > y and b otherwise.
+ * The lanes are stored to lanePower and laneBin, the return value is the first bin that was not searched.
+ */
+#define DEFINE_PEAK_SEARCH(name, attributes, vector, width, load, store, set1, add, mul, max, selectGreater) \
+attributes static int name(const sample_t *real, const sample_t *imag, int minBin, int maxBin, sample_t *lanePower, sample_t *laneBin) { \
+	sample_t firstBins[width]; \
+	for (int j = 0; j < width; j++) \
+		firstBins[j] = minBin + j; \
+	vector maxPower = set1(1), bestBin = set1(0), bin = load(firstBins), step = set1(width); \
+	int i = minBin; \
+	for (; i + width <= maxBin; i += width) { \
+		vector re = load(real + i), im = load(imag + i); \
+		vector power = add(mul(re, re), mul(im, im)); \
+		bestBin = selectGreater(power, maxPower, bin, bestBin); \
+		maxPower = max(power, maxPower); \
+		bin = add(bin, step); \
+	} \
+	store(lanePower, maxPower); \
+	store(laneBin, bestBin); \
+	return i; \
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#ifdef SINGLE_PRECISION
+#define SSE2_WIDTH 4
+#define AVX2_WIDTH 8
+__attribute__((target("sse2"))) static inline __m128 selectGreaterSse2(__m128 x, __m128 y, __m128 a, __m128 b) {
+	__m128 mask = _mm_cmpgt_ps(x, y);
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+__attribute__((target("avx2"))) static inline __m256 selectGreaterAvx2(__m256 x, __m256 y, __m256 a, __m256 b) {
+	return _mm256_blendv_ps(b, a, _mm256_cmp_ps(x, y, _CMP_GT_OQ));
+}
+DEFINE_PEAK_SEARCH(peakSearchSse2, __attribute__((target("sse2"))), __m128, SSE2_WIDTH,
+		_mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_add_ps, _mm_mul_ps, _mm_max_ps, selectGreaterSse2)
+DEFINE_PEAK_SEARCH(peakSearchAvx2, __attribute__((target("avx2"))), __m256, AVX2_WIDTH,
+		_mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_add_ps, _mm256_mul_ps, _mm256_max_ps, selectGreaterAvx2)
+#else
+#define SSE2_WIDTH 2
+#define AVX2_WIDTH 4
+__attribute__((target("sse2"))) static inline __m128d selectGreaterSse2(__m128d x, __m128d y, __m128d a, __m128d b) {
+	__m128d mask = _mm_cmpgt_pd(x, y);
+	return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+__attribute__((target("avx2"))) static inline __m256d selectGreaterAvx2(__m256d x, __m256d y, __m256d a, __m256d b) {
+	return _mm256_blendv_pd(b, a, _mm256_cmp_pd(x, y, _CMP_GT_OQ));
+}
+DEFINE_PEAK_SEARCH(peakSearchSse2, __attribute__((target("sse2"))), __m128d, SSE2_WIDTH,
+		_mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_mul_pd, _mm_max_pd, selectGreaterSse2)
+DEFINE_PEAK_SEARCH(peakSearchAvx2, __attribute__((target("avx2"))), __m256d, AVX2_WIDTH,
+		_mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_mul_pd, _mm256_max_pd, selectGreaterAvx2)
+#endif
+#endif
+
+/*
+ * NEON on 32 bit ARM has no double precision vectors and needs the compiler flag -mfpu=neon
+ */
+#if defined(SINGLE_PRECISION) && defined(__ARM_NEON)
+#define HAS_NEON_PEAK_SEARCH
+#define NEON_WIDTH 4
+static inline float32x4_t selectGreaterNeon(float32x4_t x, float32x4_t y, float32x4_t a, float32x4_t b) {
+	return vbslq_f32(vcgtq_f32(x, y), a, b);
+}
+DEFINE_PEAK_SEARCH(peakSearchNeon, , float32x4_t, NEON_WIDTH,
+		vld1q_f32, vst1q_f32, vdupq_n_f32, vaddq_f32, vmulq_f32, vmaxq_f32, selectGreaterNeon)
+#elif defined(__aarch64__)
+#define HAS_NEON_PEAK_SEARCH
+#define NEON_WIDTH 2
+static inline float64x2_t selectGreaterNeon(float64x2_t x, float64x2_t y, float64x2_t a, float64x2_t b) {
+	return vbslq_f64(vcgtq_f64(x, y), a, b);
+}
+DEFINE_PEAK_SEARCH(peakSearchNeon, , float64x2_t, NEON_WIDTH,
+		vld1q_f64, vst1q_f64, vdupq_n_f64, vaddq_f64, vmulq_f64, vmaxq_f64, selectGreaterNeon)
+#endif
+
+/**
+The vectorized search of the widest instruction set of the processor covers the band in steps of its vector width, the remaining bins
+are searched by the scalar loop. The lanes are merged first, on equal power the lower bin wins like in getFrequencyBin. All bins
+of the scalar loop are higher than those of the lanes, such that it only takes strictly louder bins.
+**/
+void findSpectralPeak(SpectralPeak *peak, const sample_t *restrict real, const sample_t *restrict imag, int minBin, int maxBin, int sampleSize){
+    sample_t lanePower[8], laneBin[8];
+    int lanes = 0;
+    int i = minBin;
+    int features = getCpuFeatures();
+    (void)features;
+#if defined(__x86_64__) || defined(__i386__)
+    if(features & CPU_FEATURE_AVX2){
+        i = peakSearchAvx2(real, imag, minBin, maxBin, lanePower, laneBin);
+        lanes = AVX2_WIDTH;
+    }else if(features & CPU_FEATURE_SSE2){
+        i = peakSearchSse2(real, imag, minBin, maxBin, lanePower, laneBin);
+        lanes = SSE2_WIDTH;
+    }
+#elif defined(HAS_NEON_PEAK_SEARCH)
+    if(features & CPU_FEATURE_NEON){
+        i = peakSearchNeon(real, imag, minBin, maxBin, lanePower, laneBin);
+        lanes = NEON_WIDTH;
+    }
+#endif
+    sample_t maxPower = 1;
+    int maxBinFound = 0;
+    for(int j = 0; j < lanes; j++){
+        if(lanePower[j] > maxPower || (lanePower[j] == maxPower && (int)laneBin[j] < maxBinFound)){
+            maxPower = lanePower[j];
+            maxBinFound = (int)laneBin[j];
+        }
+    }
+    for(; i < maxBin; i++){
+        sample_t power = real[i]*real[i] + imag[i]*imag[i];
+        if(power > maxPower){
+            maxPower = power;
+            maxBinFound = i;
+        }
+    }
+    peak->bin = maxBinFound;
+    peak->power = maxBinFound > 0 ? maxPower : 0;
+    peak->lowerPower = maxBinFound > 0 ? real[maxBinFound-1]*real[maxBinFound-1] + imag[maxBinFound-1]*imag[maxBinFound-1] : 0;
+    peak->upperPower = maxBinFound > 0 && maxBinFound < sampleSize/2 ? real[maxBinFound+1]*real[maxBinFound+1] + imag[maxBinFound+1]*imag[maxBinFound+1] : 0;
+}
+
+/**
+The logarithm of the main lobe of a windowed sinusoid is close to a parabola, for the gaussian window it is one. The vertex of the parabola
+through the logarithmic power of the peak and its neighbours lies at bin+0.5*(a-c)/(a-2b+c) with a, b and c the logarithms of the lower,
+peak and upper power. The logarithm of the power instead of the magnitude only scales a, b and c and leaves the vertex unchanged.
+@see Julius O. Smith, Spectral Audio Signal Processing, Quadratic Interpolation of Spectral Peaks
+**/
+double getPeakPosition(const SpectralPeak *peak){
+    if (peak->bin <= 0 || peak->lowerPower <= 0 || peak->upperPower <= 0) {
+        return peak->bin;
+    }
+    double lower = log(peak->lowerPower);
+    double center = log(peak->power);
+    double upper = log(peak->upperPower);
+    double curvature = lower - 2 * center + upper;
+    if (curvature >= 0) {
+        return peak->bin;
+    }
+    double offset = 0.5 * (lower - upper) / curvature;
+    return peak->bin + fmax(-0.5, fmin(0.5, offset));
+}
+
+/**
+Every bin k of the octave gets a complex atom of Q*Fs/f_k samples with a hamming window and the frequency f_k, normalized by its length.
+The atom ends with the frame, such that every bin looks at the most recent samples. The kernel row is the conjugated spectrum of the atom
+divided by the fft length, the inner product of the spectra then equals the inner product of frame and atom.
+@see Judith C. Brown and Miller S. Puckette, An efficient algorithm for the calculation of a constant Q transform, 1992
+**/
+static ConstantQKernel *createConstantQKernel(double sampleRate, double minFrequency, int binsPerOctave){
+    double Q = 1/(pow(2.0,1.0/binsPerOctave)-1);
+    int maxAtomLength = (int)ceil(Q * sampleRate / minFrequency);
+    int N = 1;
+    while (N < maxAtomLength) {
+        N <<= 1;
+    }
+    ConstantQKernel *kernel = (ConstantQKernel *)calloc(1,sizeof(ConstantQKernel));
+    kernel->sampleRate = sampleRate;
+    kernel->minFrequency = minFrequency;
+    kernel->binsPerOctave = binsPerOctave;
+    kernel->fftLength = N;
+    kernel->rowStart = (int *)calloc(binsPerOctave + 1,sizeof(int));
+
+    double *real = (double *)malloc(N * sizeof(double));
+    double *imag = (double *)malloc(N * sizeof(double));
+    int capacity = 0;
+    for (int b = 0; b < binsPerOctave; b++) {
+        double frequency = minFrequency * pow(2.0,(double)b/binsPerOctave);
+        int atomLength = (int)ceil(Q * sampleRate / frequency);
+        memset(real, 0, N * sizeof(double));
+        memset(imag, 0, N * sizeof(double));
+        for (int n = 0; n < atomLength; n++) {
+            double windowCoefficient = (0.54 - 0.46 * cos(2 * M_PI * n / atomLength)) / atomLength;
+            real[N - atomLength + n] = windowCoefficient * cos(2 * M_PI * frequency * n / sampleRate);
+            imag[N - atomLength + n] = windowCoefficient * sin(2 * M_PI * frequency * n / sampleRate);
+        }
+        Fft_transform(real, imag, N);
+
+        //only the non-redundant bins of the real fft of the frame are used, the atom has nearly no energy at negative frequencies
+        double maxMagnitude = 0;
+        for (int k = 0; k <= N/2; k++) {
+            maxMagnitude = fmax(maxMagnitude, hypot(real[k], imag[k]));
+        }
+        int start = kernel->rowStart[b];
+        int numEntries = 0;
+        for (int k = 0; k <= N/2; k++) {
+            if (hypot(real[k], imag[k]) < CONSTANT_Q_THRESHOLD * maxMagnitude) {
+                continue;
+            }
+            if (start + numEntries == capacity) {
+                capacity = capacity ? 2 * capacity : 256;
+                kernel->columns = (int *)realloc(kernel->columns, capacity * sizeof(int));
+                kernel->kernelReal = (sample_t *)realloc(kernel->kernelReal, capacity * sizeof(sample_t));
+                kernel->kernelImag = (sample_t *)realloc(kernel->kernelImag, capacity * sizeof(sample_t));
+            }
+            kernel->columns[start + numEntries] = k;
+            kernel->kernelReal[start + numEntries] = real[k] / N;
+            kernel->kernelImag[start + numEntries] = -imag[k] / N;
+            numEntries++;
+        }
+        kernel->rowStart[b + 1] = start + numEntries;
+    }
+    free(real);
+    free(imag);
+    return kernel;
+}
+
+/**
+The cache is shared by all threads, a kernel is never changed after it was created.
+**/
+static ConstantQKernel *getConstantQKernel(double sampleRate, double minFrequency, int binsPerOctave){
+    pthread_mutex_lock(&constantQKernelMutex);
+    ConstantQKernel *kernel = constantQKernels;
+    while (kernel != NULL && (kernel->sampleRate != sampleRate || kernel->minFrequency != minFrequency || kernel->binsPerOctave != binsPerOctave)) {
+        kernel = kernel->next;
+    }
+    if (kernel == NULL) {
+        kernel = createConstantQKernel(sampleRate, minFrequency, binsPerOctave);
+        kernel->next = constantQKernels;
+        constantQKernels = kernel;
+    }
+    pthread_mutex_unlock(&constantQKernelMutex);
+    return kernel;
+}
+
+void freeConstantQKernels(void){
+    pthread_mutex_lock(&constantQKernelMutex);
+    while (constantQKernels != NULL) {
+        ConstantQKernel *next = constantQKernels->next;
+        free(constantQKernels->rowStart);
+        free(constantQKernels->columns);
+        free(constantQKernels->kernelReal);
+        free(constantQKernels->kernelImag);
+        free(constantQKernels);
+        constantQKernels = next;
+    }
+    pthread_mutex_unlock(&constantQKernelMutex);
+}
+
+/**
+The notes are calculated in the same way as in getBins, such that the center bins land on the positions that getBins reads.
+The halfband lowpass is a windowed sinc with the cutoff at a quarter of the sample rate of its level.
+**/
+int initConstantQTransform(ConstantQTransform *cqt, char *fftEngineName, int sampleSize, int stepSize, double sampleRate, double tuningPitch, int binsPerOctave){
+    if (binsPerOctave < 12 || binsPerOctave % 12 != 0 || (binsPerOctave / 12) % 2 == 0) {
+        fprintf(stderr, "%d bins per octave are not supported by the constant q transform!\n", binsPerOctave);
+        return 0;
+    }
+    memset(cqt, 0, sizeof(ConstantQTransform));
+    int binsPerNote = binsPerOctave / 12;
+    cqt->sampleSize = sampleSize;
+    cqt->stepSize = stepSize;
+    cqt->sampleRate = sampleRate;
+    cqt->numOctaves = CONSTANT_Q_NUM_OCTAVES;
+    cqt->binsPerOctave = binsPerOctave;
+    cqt->numBins = cqt->numOctaves * binsPerOctave;
+    cqt->frequencies = (double *)malloc(cqt->numBins * sizeof(double));
+    cqt->amplitudes = (sample_t *)calloc(cqt->numBins, sizeof(sample_t));
+    cqt->outputBins = (int *)malloc(cqt->numBins * sizeof(int));
+    cqt->positionBins = (int *)malloc((sampleSize/2 + 1) * sizeof(int));
+    for (int k = 0; k <= sampleSize/2; k++) {
+        cqt->positionBins[k] = -1;
+    }
+    for (int i = 0; i < cqt->numOctaves; i++) {
+        for (int j = 0; j < 12; j++) {
+            double noteFrequency = tuningPitch * pow(pow(2.0,1.0/12.0),j-9) * pow(2.0,(double)(0-3)) * pow(2.0,i);
+            for (int k = 0; k < binsPerNote; k++) {
+                int bin = i * binsPerOctave + j * binsPerNote + k;
+                int offset = k - binsPerNote/2;
+                cqt->frequencies[bin] = offset == 0 ? noteFrequency : noteFrequency * pow(2.0,(double)offset/binsPerOctave);
+                cqt->outputBins[bin] = (int)floor((cqt->frequencies[bin] * sampleSize)/sampleRate);
+                if (cqt->outputBins[bin] > sampleSize/2) {
+                    cqt->outputBins[bin] = sampleSize/2;
+                }
+            }
+        }
+    }
+
+    double minFrequency = cqt->frequencies[(cqt->numOctaves - 1) * binsPerOctave];
+    cqt->kernel = getConstantQKernel(sampleRate, minFrequency, binsPerOctave);
+    int N = cqt->kernel->fftLength;
+    if (!open_fft_engine(&cqt->fftEngine, fftEngineName, N)) {
+        freeConstantQTransform(cqt);
+        return 0;
+    }
+
+    cqt->history = (sample_t *)calloc(cqt->numOctaves * N, sizeof(sample_t));
+    cqt->historyPos = (int *)calloc(cqt->numOctaves, sizeof(int));
+    cqt->decimationFilter = (double *)malloc(CONSTANT_Q_FILTER_TAPS * sizeof(double));
+    cqt->delayLines = (double *)calloc(cqt->numOctaves * 2 * CONSTANT_Q_FILTER_TAPS, sizeof(double));
+    cqt->delayPos = (int *)calloc(cqt->numOctaves, sizeof(int));
+    cqt->decimationPhase = (int *)calloc(cqt->numOctaves, sizeof(int));
+    cqt->frame = (sample_t *)malloc(N * sizeof(sample_t));
+    cqt->real = (sample_t *)malloc((N/2 + 1) * sizeof(sample_t));
+    cqt->imag = (sample_t *)malloc((N/2 + 1) * sizeof(sample_t));
+
+    double sum = 0;
+    int center = CONSTANT_Q_FILTER_TAPS / 2;
+    for (int n = 0; n < CONSTANT_Q_FILTER_TAPS; n++) {
+        double x = (n - center) / 2.0;
+        double sinc = n == center ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        cqt->decimationFilter[n] = sinc * (0.54 - 0.46 * cos(2 * M_PI * n / (CONSTANT_Q_FILTER_TAPS - 1)));
+        sum += cqt->decimationFilter[n];
+    }
+    for (int n = 0; n < CONSTANT_Q_FILTER_TAPS; n++) {
+        cqt->decimationFilter[n] /= sum;
+    }
+    return 1;
+}
+
+/**
+The sample is stored in the ring buffer of its level and filtered, every second filtered sample continues to the next lower level.
+Every sample is stored twice in the delay line, such that the last CONSTANT_Q_FILTER_TAPS samples are always contiguous.
+**/
+static void pushConstantQSample(ConstantQTransform *cqt, double sample){
+    int N = cqt->kernel->fftLength;
+    for (int level = 0; level < cqt->numOctaves; level++) {
+        cqt->history[level * N + cqt->historyPos[level]] = (sample_t)sample;
+        cqt->historyPos[level] = cqt->historyPos[level] + 1 == N ? 0 : cqt->historyPos[level] + 1;
+        if (level == cqt->numOctaves - 1) {
+            return;
+        }
+        double *delayLine = cqt->delayLines + level * 2 * CONSTANT_Q_FILTER_TAPS;
+        delayLine[cqt->delayPos[level]] = sample;
+        delayLine[cqt->delayPos[level] + CONSTANT_Q_FILTER_TAPS] = sample;
+        cqt->delayPos[level] = cqt->delayPos[level] + 1 == CONSTANT_Q_FILTER_TAPS ? 0 : cqt->delayPos[level] + 1;
+        cqt->decimationPhase[level] = !cqt->decimationPhase[level];
+        if (cqt->decimationPhase[level]) {
+            return;
+        }
+        const double *taps = delayLine + cqt->delayPos[level];
+        sample = 0;
+        for (int n = 0; n < CONSTANT_Q_FILTER_TAPS; n++) {
+            sample += cqt->decimationFilter[n] * taps[n];
+        }
+    }
+}
+
+/**
+Level 0 holds the signal at the full sample rate and gives the top octave, every further level the next lower octave.
+The atoms are normalized by their length, the magnitudes are scaled by sampleSize to match the ones of a fft of sampleSize samples.
+**/
+void analyzeConstantQ(ConstantQTransform *cqt, const sample_t *inputReal, sample_t *amps){
+    ConstantQKernel *kernel = cqt->kernel;
+    int N = kernel->fftLength;
+    const sample_t *samples = inputReal + cqt->sampleSize - cqt->stepSize;
+    for (int n = 0; n < cqt->stepSize; n++) {
+        pushConstantQSample(cqt, samples[n]);
+    }
+
+    for (int level = 0; level < cqt->numOctaves; level++) {
+        sample_t *history = cqt->history + level * N;
+        int oldest = cqt->historyPos[level];
+        memcpy(cqt->frame, history + oldest, (N - oldest) * sizeof(sample_t));
+        memcpy(cqt->frame + N - oldest, history, oldest * sizeof(sample_t));
+        forward_fft_engine(cqt->fftEngine, cqt->frame, cqt->real, cqt->imag);
+
+        int octave = cqt->numOctaves - 1 - level;
+        for (int b = 0; b < cqt->binsPerOctave; b++) {
+            double real = 0;
+            double imag = 0;
+            for (int e = kernel->rowStart[b]; e < kernel->rowStart[b + 1]; e++) {
+                int k = kernel->columns[e];
+                real += cqt->real[k] * kernel->kernelReal[e] - cqt->imag[k] * kernel->kernelImag[e];
+                imag += cqt->real[k] * kernel->kernelImag[e] + cqt->imag[k] * kernel->kernelReal[e];
+            }
+            cqt->amplitudes[octave * cqt->binsPerOctave + b] = (sample_t)((double)cqt->sampleSize * cqt->sampleSize * (real*real + imag*imag));
+        }
+    }
+
+    int lastBin = -1;
+    for (int i = 0; i < cqt->numBins; i++) {
+        int bin = cqt->outputBins[i];
+        if (bin != lastBin || cqt->amplitudes[i] > amps[bin]) {
+            amps[bin] = cqt->amplitudes[i];
+            cqt->positionBins[bin] = i;
+        }
+        lastBin = bin;
+    }
+}
+
+/**
+Below about 100Hz a position of a 16384 point fft is wider than a semitone, the center frequency of the bin is exact.
+**/
+double getConstantQFrequency(ConstantQTransform *cqt, int position){
+    if (position < 0 || position > cqt->sampleSize/2 || cqt->positionBins[position] < 0) {
+        return (double)position * cqt->sampleRate/cqt->sampleSize;
+    }
+    return cqt->frequencies[cqt->positionBins[position]];
+}
+
+void freeConstantQTransform(ConstantQTransform *cqt){
+    if (cqt->fftEngine != NULL) {
+        close_fft_engine(cqt->fftEngine);
+    }
+    free(cqt->frequencies);
+    free(cqt->amplitudes);
+    free(cqt->outputBins);
+    free(cqt->positionBins);
+    free(cqt->history);
+    free(cqt->historyPos);
+    free(cqt->decimationFilter);
+    free(cqt->delayLines);
+    free(cqt->delayPos);
+    free(cqt->decimationPhase);
+    free(cqt->frame);
+    free(cqt->real);
+    free(cqt->imag);
+}
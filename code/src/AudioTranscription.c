@@ -9,12 +9,18 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "../include/ApplicationMacros.h"
 #include "../include/AudioTranscription.h"
 #include "../include/HelperFunctions.h"
 #include "../include/Structures.h"
 
+#define NOTE_TABLE_INTERPOLATION_BIN 32 ///< lowest bin whose note position is interpolated, the error is below 0.25 cents from there on
+
+static NoteTable *noteTables = NULL;    ///< note tables of all configurations used so far
+static pthread_mutex_t noteTablesMutex = PTHREAD_MUTEX_INITIALIZER; ///< protects the note table cache
+
 /**
 The function starts out from with the frequencies of the lowest octave. The frequencies of
 the corresponding notes one octave higher are related with the factor 2. Afterwards the musical
@@ -484,37 +490,112 @@ void getMaximalBin(int *bins, int numBins, float *out, int N){
 }
 
 /**
-Basically iterates through the coefficient array out and whenever a bin is found with a
-higher power level than one of the bins saved in bins, the array bins is updated. In the
-end, the array bins will have the indexes of the bins with with numBins maximal power levels.
+The note table of the configuration holds the note bins, getPeakBins picks the loudest of them.
 **/
-void getBins(int *bins, int numBins, double *out, int N, double Fs, double tuningPitch){
-  float power = 0;
-  int numNotesPerOctave = 12;
-  double basicFrequencies[numNotesPerOctave];
-  for (int i = 0; i < numNotesPerOctave; i++) {
-    double freq = tuningPitch * pow(pow(2.0,1.0/12.0),i-9) * pow(2.0,(double)(0-3));
-    basicFrequencies[i] = freq;
+void getBins(int *bins, int numBins, sample_t *out, int N, double Fs, double tuningPitch){
+  const NoteTable *noteTable = getNoteTable(N, Fs, tuningPitch, PITCH_RESOLUTION);
+  getPeakBins(bins, numBins, out, noteTable);
+}
+
+/**
+The harmonics 2 to 6 of a note lie these numbers of semitones above it.
+**/
+static const int harmonicIntervals[] = {12, 19, 24, 28, 31};
+
+/**
+The heap keeps the numPeaks loudest candidates found so far with the quietest one at the root, a candidate replaces the root if it is louder.
+**/
+static void siftDownPeak(int *bins, sample_t *powers, int numPeaks, int index){
+  while (1) {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < numPeaks && powers[left] < powers[smallest]) {
+      smallest = left;
+    }
+    if (right < numPeaks && powers[right] < powers[smallest]) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      return;
+    }
+    int bin = bins[index];
+    sample_t power = powers[index];
+    bins[index] = bins[smallest];
+    powers[index] = powers[smallest];
+    bins[smallest] = bin;
+    powers[smallest] = power;
+    index = smallest;
   }
-  int numOctaves = 6;
-  for (int i = 0; i < numOctaves; i++) {
-    for (int j = 0; j < numNotesPerOctave; j++) {
-        double freq = basicFrequencies[j] * pow(2.0,i);
-        int currentBin = (int)floor((freq * N)/(double)Fs);
-        power = out[currentBin];
-        //power = out[currentBin] * out[currentBin];
-        //power = 10.0f * log10f(fmaxf(0.000001f, power));
-        //printf("%f\n", power);
-
-        int minBinIndex = 0;
-        for (int k = 0; k < numBins; k++) {
-          if (out[bins[k]] < out[bins[minBinIndex]]) {
-            minBinIndex = k;
-          }
+}
+
+/**
+The floor of a note frequency lands on the bin of its peak or one bin below it, so the louder of the two is the peak of the note.
+A note is a candidate if its peak is louder than a magnitude of 1 and a local maximum of the spectrum. A peak on the bin of the next
+note belongs to that note, notes sharing a bin with a lower note are skipped.
+Candidates at a harmonic of a candidate that is louder by more than the HARMONIC_SUPPRESSION_FACTOR are overtones and dropped,
+the remaining ones pass through the heap and are sorted by heapsort.
+**/
+int getPeakBins(int *bins, int numBins, const sample_t *amps, const NoteTable *noteTable){
+  sample_t notePowers[NUM_NOTE_BINS];
+  sample_t heapPowers[NUM_NOTE_BINS];
+  int heapBins[NUM_NOTE_BINS];
+  int maxPeaks = numBins < NUM_NOTE_BINS ? numBins : NUM_NOTE_BINS;
+  int numPeaks = 0;
+  const int *noteBins = noteTable->noteBins;
+  int lastBin = noteTable->numBins - 1;
+  for (int note = 0; note < NUM_NOTE_BINS; note++) {
+    int bin = noteBins[note];
+    notePowers[note] = 0;
+    if ((note > 0 && bin == noteBins[note-1]) || bin <= 0 || bin >= lastBin) {
+      continue;
+    }
+    int peak = amps[bin+1] > amps[bin] ? bin + 1 : bin;
+    if ((peak != bin && note + 1 < NUM_NOTE_BINS && noteBins[note+1] == peak) || peak >= lastBin) {
+      continue;
+    }
+    sample_t power = amps[peak];
+    if (power <= 1 || power < amps[peak-1] || power < amps[peak+1]) {
+      continue;
+    }
+    notePowers[note] = power;
+    int isHarmonic = 0;
+    for (size_t i = 0; i < sizeof(harmonicIntervals)/sizeof(harmonicIntervals[0]) && note >= harmonicIntervals[i]; i++) {
+      isHarmonic |= power < HARMONIC_SUPPRESSION_FACTOR * notePowers[note - harmonicIntervals[i]];
+    }
+    if (isHarmonic) {
+      continue;
+    }
+    if (numPeaks < maxPeaks) {
+      heapBins[numPeaks] = bin;
+      heapPowers[numPeaks] = power;
+      numPeaks++;
+      if (numPeaks == maxPeaks) {
+        for (int i = numPeaks/2 - 1; i >= 0; i--) {
+          siftDownPeak(heapBins, heapPowers, numPeaks, i);
         }
-        bins[minBinIndex] = out[bins[minBinIndex]] < power ? currentBin : bins[minBinIndex];
+      }
+    }else if (maxPeaks > 0 && power > heapPowers[0]) {
+      heapBins[0] = bin;
+      heapPowers[0] = power;
+      siftDownPeak(heapBins, heapPowers, numPeaks, 0);
     }
   }
+  if (numPeaks < maxPeaks) {
+    for (int i = numPeaks/2 - 1; i >= 0; i--) {
+      siftDownPeak(heapBins, heapPowers, numPeaks, i);
+    }
+  }
+  for (int i = numPeaks - 1; i >= 0; i--) {
+    bins[i] = heapBins[0];
+    heapBins[0] = heapBins[i];
+    heapPowers[0] = heapPowers[i];
+    siftDownPeak(heapBins, heapPowers, i, 0);
+  }
+  for (int i = numPeaks; i < numBins; i++) {
+    bins[i] = 0;
+  }
+  return numPeaks;
 }
 
 /*void getBins(int *bins, int numBins, float *out, int N){
@@ -533,94 +614,132 @@ void getBins(int *bins, int numBins, double *out, int N, double Fs, double tunin
 }*/
 
 /**
-The function calculates the musical note in lilypond format from a frequency. It looks through all the possible frequencies
-below and above the tuning pitch. If the passed frequency lies in an acceptible range from the calculated frequency, then a note is
-found and an index will be calculated. This index can then be used to reference the musical note in the musicalNotes array and to
-calculate the footer of the string to identify its octave.
+The nearest note of a frequency is the rounded midi note position 69+12*log2(frequency/tuningPitch), the difference to it is the
+fractional part of the position in hundredths of a semitone.
 @see https://pages.mtu.edu/~suits/NoteFreqCalcs.html
 **/
-char *getMusicalNote(double frequency, double tuningPitch, double pitchResolution){
-    double lowerFrequencyLimit = 100.0;
-    double upperFrequencyLimit = 5000.0;
+static int getMidiNoteOfPosition(double position, double pitchResolution, double *cents){
+    int midiNote = (int)floor(position + 0.5);
+    double centDifference = 100 * (position - midiNote);
+    if (cents != NULL) {
+        *cents = centDifference;
+    }
+    if (centDifference > (-1) * pitchResolution && centDifference <= pitchResolution) {
+        return midiNote;
+    }
+    return NO_MIDI_NOTE;
+}
+
+int getMidiNote(double frequency, double tuningPitch, double pitchResolution, double *cents){
+    if (frequency < NOTE_LOWEST_FREQUENCY || frequency > NOTE_HIGHEST_FREQUENCY) {
+        if (cents != NULL) {
+            *cents = 0;
+        }
+        return NO_MIDI_NOTE;
+    }
+    return getMidiNoteOfPosition(69 + 12 * log2(frequency/tuningPitch), pitchResolution, cents);
+}
+
+/**
+The octave of a midi note starts with c, the octave of c' is 4 and every octave above or below adds a ' or a , respectively.
+**/
+char *getLilyPondNote(int midiNote){
+    char musicalNotes[][4]={"c","cis","d","dis","e","f","fis","g","gis","a","ais","b"};
     char *musicalNote = (char *) calloc(32,sizeof(char));
-    if (frequency < lowerFrequencyLimit || frequency > upperFrequencyLimit) {
-      strcpy(musicalNote, "");
-      return musicalNote;
-    }//array from a to next a
-    char musicalNotes[][13]={
-        "a",
-        "ais",
-        "b",
-        "c",
-        "cis",
-        "d",
-        "dis",
-        "e",
-        "f",
-        "fis",
-        "g",
-        "gis",
-        "a"
-    };
-    //int frequencyFound = 0;
-    //fall für runter
-    if(frequency <= tuningPitch){
-        for (int octave = 0;octave < 5;octave++){
-            for(int note = 0; note < 12;note++){
-                double currentFrequency = tuningPitch * powl(powl(2,1./12),(octave * 12 + note) * (-1));
-                double centDifference = 1200 * log(frequency/currentFrequency)/log(2);
-                if (centDifference > (-1) * pitchResolution && centDifference <= pitchResolution){
-                    //frequencyFound = 1;
-                    strcpy(musicalNote,musicalNotes[sizeof(musicalNotes)/sizeof(musicalNotes[0]) - note - 1]);
-                    if(octave == 0){
-                        if(note <= 9){
-                        //zeichne octave viele Kommas
-                            strcat(musicalNote,"'");
-                        }
-                    } else{
-                        if(note <= 9){
-                            //zeichne octave viele Kommas
-                            for(int i = 0; i < octave-1; i++){
-                                strcat(musicalNote,",");
-                            }
-                        } else{
-                            //zeichne octave +1 viele Kommas
-                            for(int i = 0; i < octave;i++){
-                                strcat(musicalNote,",");
-                            }
-                        }
-                    }
-                    return musicalNote;
-                }
+    if (midiNote == NO_MIDI_NOTE) {
+        return musicalNote;
+    }
+    int octave = midiNote/12 - 1;
+    strcpy(musicalNote, musicalNotes[midiNote % 12]);
+    for (int i = 3; i < octave; i++) {
+        strcat(musicalNote, "'");
+    }
+    for (int i = octave; i < 3; i++) {
+        strcat(musicalNote, ",");
+    }
+    return musicalNote;
+}
+
+/**
+The function calculates the musical note in lilypond format from a frequency. The frequency is transformed to the nearest midi note,
+which is rendered by getLilyPondNote if the frequency lies in an acceptible range from the frequency of the note.
+**/
+char *getMusicalNote(double frequency, double tuningPitch, double pitchResolution){
+    return getLilyPondNote(getMidiNote(frequency, tuningPitch, pitchResolution, NULL));
+}
+
+/**
+The cache is shared by all threads, the tables are never changed after they were calculated.
+**/
+const NoteTable *getNoteTable(int sampleSize, double sampleRate, double tuningPitch, double pitchResolution){
+    pthread_mutex_lock(&noteTablesMutex);
+    NoteTable *noteTable = noteTables;
+    while (noteTable != NULL && (noteTable->sampleSize != sampleSize || noteTable->sampleRate != sampleRate || noteTable->tuningPitch != tuningPitch || noteTable->pitchResolution != pitchResolution)) {
+        noteTable = noteTable->next;
+    }
+    if (noteTable == NULL) {
+        noteTable = (NoteTable *)calloc(1,sizeof(NoteTable));
+        noteTable->sampleSize = sampleSize;
+        noteTable->sampleRate = sampleRate;
+        noteTable->tuningPitch = tuningPitch;
+        noteTable->pitchResolution = pitchResolution;
+        noteTable->numBins = sampleSize/2 + 1;
+        noteTable->notePositions = (float *)calloc(noteTable->numBins,sizeof(float));
+        noteTable->midiNotes = (short *)malloc(noteTable->numBins * sizeof(short));
+        noteTable->cents = (float *)malloc(noteTable->numBins * sizeof(float));
+        for (int bin = 0; bin < noteTable->numBins; bin++) {
+            double frequency = (double)bin * sampleRate / sampleSize;
+            double cents;
+            if (bin > 0) {
+                noteTable->notePositions[bin] = (float)(69 + 12 * log2(frequency/tuningPitch));
             }
+            noteTable->midiNotes[bin] = (short)getMidiNote(frequency, tuningPitch, pitchResolution, &cents);
+            noteTable->cents[bin] = (float)cents;
         }
-    }else {
-        for (int octave = 0;octave < 5;octave++){
-            for(int note = 0; note < 12;note++){
-                double currentFrequency = tuningPitch * powl(powl(2,1./12),octave * 12 + note);
-                double centDifference = 1200 * log(frequency/currentFrequency)/log(2);
-                if (centDifference > (-1) * pitchResolution && centDifference <= pitchResolution){
-                    //frequencyFound = 1;
-                    //char *musicalNote = (char *) calloc(32,sizeof(char));
-                    strcpy(musicalNote,musicalNotes[note]);
-                    if(note <= 2){
-                        //zeichne octave viele '
-                        for(int i = 0; i < octave+1; i++){
-                            strcat(musicalNote,"'");
-                        }
-                    } else{
-                        //zeichne octave +1 viele '
-                        for(int i = 0;i < octave+2; i++){
-                            strcat(musicalNote,"'");
-                        }
-                    }
-                    return musicalNote;
-                }
-            }
+        for (int i = 0; i < NUM_NOTE_BINS; i++) {
+            double frequency = tuningPitch * pow(pow(2.0,1.0/12.0),i%12-9) * pow(2.0,(double)(0-3)) * pow(2.0,i/12);
+            noteTable->noteBins[i] = (int)floor((frequency * sampleSize)/sampleRate);
         }
+        noteTable->next = noteTables;
+        noteTables = noteTable;
     }
-    strcpy(musicalNote, "");
-    return musicalNote;
+    pthread_mutex_unlock(&noteTablesMutex);
+    return noteTable;
+}
+
+int getNoteOfBin(const NoteTable *noteTable, int bin, double *cents){
+    if (cents != NULL) {
+        *cents = noteTable->cents[bin];
+    }
+    return noteTable->midiNotes[bin];
+}
+
+/**
+The note position log2 of the frequency is concave, linear interpolation between the bins i and i+1 underestimates it by at most
+12/(8*ln(2)*i^2) semitones.
+**/
+int getNoteOfBinPosition(const NoteTable *noteTable, double position, double *cents){
+    double frequency = position * noteTable->sampleRate / noteTable->sampleSize;
+    int bin = (int)position;
+    if (bin < NOTE_TABLE_INTERPOLATION_BIN || bin + 1 >= noteTable->numBins || frequency < NOTE_LOWEST_FREQUENCY || frequency > NOTE_HIGHEST_FREQUENCY) {
+        return getMidiNote(frequency, noteTable->tuningPitch, noteTable->pitchResolution, cents);
+    }
+    double fraction = position - bin;
+    double notePosition = noteTable->notePositions[bin] + fraction * (noteTable->notePositions[bin+1] - noteTable->notePositions[bin]);
+    return getMidiNoteOfPosition(notePosition, noteTable->pitchResolution, cents);
+}
+
+void freeNoteTables(void){
+    pthread_mutex_lock(&noteTablesMutex);
+    while (noteTables != NULL) {
+        NoteTable *next = noteTables->next;
+        free(noteTables->notePositions);
+        free(noteTables->midiNotes);
+        free(noteTables->cents);
+        free(noteTables);
+        noteTables = next;
+    }
+    pthread_mutex_unlock(&noteTablesMutex);
 }
 
 /**
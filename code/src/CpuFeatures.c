@@ -0,0 +1,44 @@
+/**
+@file CpuFeatures.c
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the runtime detection of instruction set extensions.
+**/
+#if defined(__arm__) || defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#include "../include/CpuFeatures.h"
+
+/**
+On x86 the CPUID instruction is queried through the compiler builtins. On ARM the kernel reports the
+features of the processor in the auxiliary vector (HWCAP). NEON is mandatory on 64 bit ARM, but is
+optional on 32 bit ARM systems like older Raspberry Pi distributions.
+**/
+int getCpuFeatures(void){
+  static int features = -1;
+  if (features >= 0) {
+    return features;
+  }
+  int detected = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    detected |= CPU_FEATURE_SSE2;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    detected |= CPU_FEATURE_AVX2;
+  }
+#elif defined(__aarch64__)
+  if (getauxval(AT_HWCAP) & HWCAP_ASIMD) {
+    detected |= CPU_FEATURE_NEON;
+  }
+#elif defined(__arm__)
+  if (getauxval(AT_HWCAP) & HWCAP_NEON) {
+    detected |= CPU_FEATURE_NEON;
+  }
+#endif
+  features = detected;
+  return features;
+}
@@ -13,13 +13,29 @@
 
 #include "../include/FFT.h"
 
+/*
+ * Plans are cached per thread, so a plan is never shared between the capture and the
+ * processing thread and the cache does not need any locking.
+ */
+static __thread FftPlan *planCache = NULL;
+
+
 bool Fft_transform(double real[], double imag[], size_t n) {
 	if (n == 0)
 		return true;
-	else if ((n & (n - 1)) == 0)  // Is power of 2
+#ifdef SINGLE_PRECISION
+	else if ((n & (n - 1)) == 0)  // Is power of 2, planned transforms run in single precision
 		return Fft_transformRadix2(real, imag, n);
 	else  // More complicated algorithm for arbitrary sizes
 		return Fft_transformBluestein(real, imag, n);
+#else
+	else {  // Power of 2 or Bluestein plan, one-shot transforms also run on threads that never free the plan cache
+		FftPlan *plan = Fft_createPlan(n);
+		bool status = Fft_transformPlanned(plan, real, imag);
+		Fft_destroyPlan(plan);
+		return status;
+	}
+#endif
 }
 
 
@@ -90,6 +106,385 @@ cleanup:
 }
 
 
+/*
+ * Bluestein's algorithm expresses the dft of size n as a convolution with the chirp exp(pi*i*k*k/n), which is
+ * computed with power of 2 ffts of size m >= 2*n+1. Everything that does not depend on the input is precomputed:
+ * the chirp, the spectrum of the convolution kernel (already divided by m) and the plan of size m.
+ */
+static bool createBluesteinTables(FftPlan *plan) {
+	size_t n = plan->n;
+
+	// Find a power-of-2 convolution length m such that m >= n * 2 + 1
+	size_t m = 1;
+	while (m / 2 <= n) {
+		if (m > SIZE_MAX / 2)
+			return false;
+		m *= 2;
+	}
+	if (SIZE_MAX / sizeof(sample_t) < m)
+		return false;
+
+	plan->convolution = Fft_createPlan(m);
+	plan->chirpCos = malloc(n * sizeof(sample_t));
+	plan->chirpSin = malloc(n * sizeof(sample_t));
+	plan->kernelReal = calloc(m, sizeof(sample_t));
+	plan->kernelImag = calloc(m, sizeof(sample_t));
+	plan->workReal = malloc(m * sizeof(sample_t));
+	plan->workImag = malloc(m * sizeof(sample_t));
+	if (plan->convolution == NULL || plan->chirpCos == NULL || plan->chirpSin == NULL
+			|| plan->kernelReal == NULL || plan->kernelImag == NULL
+			|| plan->workReal == NULL || plan->workImag == NULL)
+		return false;
+
+	// Trignometric tables
+	for (size_t i = 0; i < n; i++) {
+		unsigned long long temp = (unsigned long long)i * i;
+		temp %= (unsigned long long)n * 2;
+		double angle = M_PI * temp / n;
+		plan->chirpCos[i] = cos(angle);
+		plan->chirpSin[i] = sin(angle);
+	}
+
+	// Spectrum of the convolution kernel, the scaling of the inverse fft is folded into it
+	plan->kernelReal[0] = plan->chirpCos[0];
+	plan->kernelImag[0] = plan->chirpSin[0];
+	for (size_t i = 1; i < n; i++) {
+		plan->kernelReal[i] = plan->kernelReal[m - i] = plan->chirpCos[i];
+		plan->kernelImag[i] = plan->kernelImag[m - i] = plan->chirpSin[i];
+	}
+	Fft_transformPlanned(plan->convolution, plan->kernelReal, plan->kernelImag);
+	for (size_t i = 0; i < m; i++) {
+		plan->kernelReal[i] /= m;
+		plan->kernelImag[i] /= m;
+	}
+	return true;
+}
+
+
+/*
+ * Runs the dft of a Bluestein plan. A missing imaginary part is treated as zero and only the first count
+ * bins are written, such that the same code serves the complex and the real transform. The output may
+ * overlap the input.
+ */
+static void transformBluestein(const FftPlan *plan, const sample_t inReal[], const sample_t inImag[],
+		sample_t outReal[], sample_t outImag[], size_t count) {
+	size_t n = plan->n;
+	size_t m = plan->convolution->n;
+	sample_t *areal = plan->workReal;
+	sample_t *aimag = plan->workImag;
+	const sample_t *cos_table = plan->chirpCos;
+	const sample_t *sin_table = plan->chirpSin;
+
+	// Preprocessing
+	for (size_t i = 0; i < n; i++) {
+		sample_t xi = inImag != NULL ? inImag[i] : 0;
+		areal[i] =  inReal[i] * cos_table[i] + xi * sin_table[i];
+		aimag[i] = -inReal[i] * sin_table[i] + xi * cos_table[i];
+	}
+	memset(areal + n, 0, (m - n) * sizeof(sample_t));
+	memset(aimag + n, 0, (m - n) * sizeof(sample_t));
+
+	// Convolution, the inverse fft is a forward fft with real and imaginary part exchanged
+	Fft_transformPlanned(plan->convolution, areal, aimag);
+	for (size_t i = 0; i < m; i++) {
+		sample_t temp = areal[i] * plan->kernelReal[i] - aimag[i] * plan->kernelImag[i];
+		aimag[i] = aimag[i] * plan->kernelReal[i] + areal[i] * plan->kernelImag[i];
+		areal[i] = temp;
+	}
+	Fft_transformPlanned(plan->convolution, aimag, areal);
+
+	// Postprocessing
+	for (size_t i = 0; i < count; i++) {
+		outReal[i] =  areal[i] * cos_table[i] + aimag[i] * sin_table[i];
+		outImag[i] = -areal[i] * sin_table[i] + aimag[i] * cos_table[i];
+	}
+}
+
+
+FftPlan *Fft_createPlan(size_t n) {
+	int levels = 0;  // Compute levels = floor(log2(n))
+	for (size_t temp = n; temp > 1U; temp >>= 1)
+		levels++;
+	if (n == 0)
+		return NULL;
+	if (SIZE_MAX / sizeof(sample_t) < n / 2 || SIZE_MAX / (2 * sizeof(size_t)) < n)
+		return NULL;
+
+	FftPlan *plan = calloc(1, sizeof(FftPlan));
+	if (plan == NULL)
+		return NULL;
+	plan->n = n;
+	plan->levels = levels;
+	plan->cosTable = malloc((n / 2 + 1) * sizeof(sample_t));
+	plan->sinTable = malloc((n / 2 + 1) * sizeof(sample_t));
+	if (plan->cosTable == NULL || plan->sinTable == NULL) {
+		Fft_destroyPlan(plan);
+		return NULL;
+	}
+
+	// Trignometric tables
+	for (size_t i = 0; i < n / 2; i++) {
+		plan->cosTable[i] = cos(2 * M_PI * i / n);
+		plan->sinTable[i] = sin(2 * M_PI * i / n);
+	}
+
+	if ((size_t)1U << levels != n) {  // n is not a power of 2
+		if (!createBluesteinTables(plan)) {
+			Fft_destroyPlan(plan);
+			return NULL;
+		}
+		return plan;
+	}
+
+	plan->swaps = malloc(n * sizeof(size_t));
+	if (plan->swaps == NULL) {
+		Fft_destroyPlan(plan);
+		return NULL;
+	}
+
+	// Only the pairs that actually have to be exchanged are stored
+	plan->numSwaps = 0;
+	for (size_t i = 0; i < n; i++) {
+		size_t j = reverse_bits(i, levels);
+		if (j > i) {
+			plan->swaps[2 * plan->numSwaps] = i;
+			plan->swaps[2 * plan->numSwaps + 1] = j;
+			plan->numSwaps++;
+		}
+	}
+
+	// The codelet of the size or else the fastest kernel of this processor is used unless another one is chosen with Fft_setKernel
+	if (!Fft_initRadix4Twiddles(plan)) {
+		Fft_destroyPlan(plan);
+		return NULL;
+	}
+	plan->codelet = Fft_getCodelet(n);
+	plan->kernel = plan->codelet != NULL ? FFT_KERNEL_CODELET : Fft_getBestKernel();
+	return plan;
+}
+
+
+void Fft_destroyPlan(FftPlan *plan) {
+	if (plan == NULL)
+		return;
+	Fft_destroyPlan(plan->convolution);
+	free(plan->workImag);
+	free(plan->workReal);
+	free(plan->kernelImag);
+	free(plan->kernelReal);
+	free(plan->chirpSin);
+	free(plan->chirpCos);
+	free(plan->scratchImag);
+	free(plan->scratchReal);
+	free(plan->radix4Twiddles);
+	free(plan->swaps);
+	free(plan->sinTable);
+	free(plan->cosTable);
+	free(plan);
+}
+
+
+FftPlan *Fft_getPlan(size_t n) {
+	for (FftPlan *plan = planCache; plan != NULL; plan = plan->next) {
+		if (plan->n == n)
+			return plan;
+	}
+	FftPlan *plan = Fft_createPlan(n);
+	if (plan == NULL)
+		return NULL;
+	plan->next = planCache;
+	planCache = plan;
+	if (n > 1 && n % 2 == 0)  // Needed by the real transform, which runs a complex fft of half the size
+		plan->half = Fft_getPlan(n / 2);
+	return plan;
+}
+
+
+void Fft_freePlans(void) {
+	while (planCache != NULL) {
+		FftPlan *plan = planCache;
+		planCache = plan->next;
+		Fft_destroyPlan(plan);
+	}
+}
+
+
+void Fft_bitReverse(const FftPlan *plan, sample_t real[], sample_t imag[]) {
+	for (size_t s = 0; s < plan->numSwaps; s++) {
+		size_t i = plan->swaps[2 * s];
+		size_t j = plan->swaps[2 * s + 1];
+		sample_t temp = real[i];
+		real[i] = real[j];
+		real[j] = temp;
+		temp = imag[i];
+		imag[i] = imag[j];
+		imag[j] = temp;
+	}
+}
+
+
+bool Fft_transformPlanned(const FftPlan *plan, sample_t real[], sample_t imag[]) {
+	if (plan == NULL)
+		return false;
+	if (plan->convolution != NULL) {
+		transformBluestein(plan, real, imag, real, imag, plan->n);
+		return true;
+	}
+	if (plan->kernel == FFT_KERNEL_CODELET) {
+		plan->codelet(real, imag);
+		return true;
+	}
+	if (plan->kernel == FFT_KERNEL_STOCKHAM)
+		return Fft_transformStockham(plan, real, imag);
+	if (plan->kernel != FFT_KERNEL_RADIX2)
+		return Fft_transformRadix4(plan, real, imag);
+	size_t n = plan->n;
+	const sample_t *cos_table = plan->cosTable;
+	const sample_t *sin_table = plan->sinTable;
+
+	// Bit-reversed addressing permutation
+	Fft_bitReverse(plan, real, imag);
+
+	// Cooley-Tukey decimation-in-time radix-2 FFT
+	for (size_t size = 2; size <= n; size *= 2) {
+		size_t halfsize = size / 2;
+		size_t tablestep = n / size;
+		for (size_t i = 0; i < n; i += size) {
+			for (size_t j = i, k = 0; j < i + halfsize; j++, k += tablestep) {
+				size_t l = j + halfsize;
+				sample_t tpre =  real[l] * cos_table[k] + imag[l] * sin_table[k];
+				sample_t tpim = -real[l] * sin_table[k] + imag[l] * cos_table[k];
+				real[l] = real[j] - tpre;
+				imag[l] = imag[j] - tpim;
+				real[j] += tpre;
+				imag[j] += tpim;
+			}
+		}
+		if (size == n)  // Prevent overflow in 'size *= 2'
+			break;
+	}
+	return true;
+}
+
+
+/*
+ * The Stockham scratch buffers are only needed by plans that use the kernel, they are kept until the plan is destroyed
+ */
+static bool allocateStockhamScratch(FftPlan *plan) {
+	if (plan->scratchReal == NULL)
+		plan->scratchReal = malloc(plan->n * sizeof(sample_t));
+	if (plan->scratchImag == NULL)
+		plan->scratchImag = malloc(plan->n * sizeof(sample_t));
+	return plan->scratchReal != NULL && plan->scratchImag != NULL;
+}
+
+
+bool Fft_transformStockham(const FftPlan *plan, sample_t real[], sample_t imag[]) {
+	if (plan == NULL || plan->scratchReal == NULL || plan->scratchImag == NULL)
+		return false;
+	size_t n = plan->n;
+	size_t half = n / 2;
+	sample_t *inReal = real, *inImag = imag;
+	sample_t *outReal = plan->scratchReal, *outImag = plan->scratchImag;
+
+	// Stage with m = n/(2*l) combines the blocks of m elements j and j+l of the input into the blocks 2*j and 2*j+1 of the output
+	for (size_t m = 1; m < n; m *= 2) {
+		size_t l = half / m;
+		for (size_t j = 0; j < l; j++) {
+			// Twiddle factor exp(-2*pi*i*j/(2*l)) = exp(-2*pi*i*j*m/n)
+			sample_t wr = plan->cosTable[j * m];
+			sample_t wi = -plan->sinTable[j * m];
+			const sample_t *ar = inReal + j * m, *ai = inImag + j * m;
+			const sample_t *br = ar + half, *bi = ai + half;
+			sample_t *cr = outReal + 2 * j * m, *ci = outImag + 2 * j * m;
+			sample_t *dr = cr + m, *di = ci + m;
+			for (size_t k = 0; k < m; k++) {
+				sample_t tr = ar[k] - br[k];
+				sample_t ti = ai[k] - bi[k];
+				cr[k] = ar[k] + br[k];
+				ci[k] = ai[k] + bi[k];
+				dr[k] = wr * tr - wi * ti;
+				di[k] = wr * ti + wi * tr;
+			}
+		}
+		sample_t *temp = inReal;
+		inReal = outReal;
+		outReal = temp;
+		temp = inImag;
+		inImag = outImag;
+		outImag = temp;
+	}
+
+	// An odd number of stages leaves the result in the scratch buffers
+	if (inReal != real) {
+		memcpy(real, inReal, n * sizeof(sample_t));
+		memcpy(imag, inImag, n * sizeof(sample_t));
+	}
+	return true;
+}
+
+
+bool Fft_setKernel(FftPlan *plan, FftKernel kernel) {
+	if (plan == NULL || !Fft_isKernelSupported(kernel))
+		return false;
+	if (kernel == FFT_KERNEL_CODELET && (plan->convolution != NULL ? plan->convolution : plan)->codelet == NULL)
+		return false;
+	if (kernel == FFT_KERNEL_STOCKHAM && !allocateStockhamScratch(plan->convolution != NULL ? plan->convolution : plan))
+		return false;
+	plan->kernel = kernel;
+	if (plan->convolution != NULL)
+		plan->convolution->kernel = kernel;
+	return true;
+}
+
+
+bool Fft_transformReal(const FftPlan *plan, const sample_t input[], sample_t outReal[], sample_t outImag[]) {
+	if (plan == NULL)
+		return false;
+	if (plan->half == NULL && plan->convolution != NULL) {  // Odd size, the samples can not be packed
+		transformBluestein(plan, input, NULL, outReal, outImag, plan->n / 2 + 1);
+		return true;
+	}
+	if (plan->half == NULL)
+		return false;
+	size_t m = plan->n / 2;
+
+	// Pack even samples into the real and odd samples into the imaginary part
+	for (size_t i = 0; i < m; i++) {
+		outReal[i] = input[2 * i];
+		outImag[i] = input[2 * i + 1];
+	}
+	if (!Fft_transformPlanned(plan->half, outReal, outImag))
+		return false;
+
+	// Split the half size spectrum into the spectra of the even and odd samples and combine them
+	sample_t z0real = outReal[0];
+	sample_t z0imag = outImag[0];
+	outReal[0] = z0real + z0imag;
+	outImag[0] = 0;
+	outReal[m] = z0real - z0imag;
+	outImag[m] = 0;
+	for (size_t k = 1; k <= m / 2; k++) {
+		sample_t areal = outReal[k], aimag = outImag[k];
+		sample_t breal = outReal[m - k], bimag = outImag[m - k];
+		sample_t evenReal = 0.5 * (areal + breal);
+		sample_t evenImag = 0.5 * (aimag - bimag);
+		sample_t oddReal = 0.5 * (aimag + bimag);
+		sample_t oddImag = -0.5 * (areal - breal);
+		// Twiddle factor exp(-2*pi*i*k/n)
+		sample_t twiddleReal = plan->cosTable[k];
+		sample_t twiddleImag = -plan->sinTable[k];
+		sample_t tpre = twiddleReal * oddReal - twiddleImag * oddImag;
+		sample_t tpim = twiddleReal * oddImag + twiddleImag * oddReal;
+		outReal[k] = evenReal + tpre;
+		outImag[k] = evenImag + tpim;
+		outReal[m - k] = evenReal - tpre;
+		outImag[m - k] = -(evenImag - tpim);
+	}
+	return true;
+}
+
+
 bool Fft_transformBluestein(double real[], double imag[], size_t n) {
 	bool status = false;
 
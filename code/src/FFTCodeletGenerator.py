@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Generates the size-specialized fft codelets of FFTCodelets.c.
+
+Usage: python3 FFTCodeletGenerator.py 64 128 ... > FFTCodeletKernels.inc
+
+Every codelet is the radix-4 algorithm of Fft_transformRadix4 for one power of two size. The bit reversal
+uses a constant table of index pairs, the first stages up to a block of 8 or 16 points are written out as
+straight-line code with literal twiddle factors (trivial ones are left out), and the remaining stages pass
+constant sizes and a constant twiddle table to fftCodeletStage, which is inlined into the codelet.
+The output is included once per instruction set, names and attributes come from CODELET_NAME and
+CODELET_ATTRIBUTES, the tables are only emitted on the first inclusion.
+"""
+import math
+import sys
+
+
+def levels_of(n):
+    levels = n.bit_length() - 1
+    if n < 16 or (1 << levels) != n:
+        raise ValueError("codelet sizes must be powers of two of at least 16: %d" % n)
+    return levels
+
+
+def reverse_bits(x, levels):
+    result = 0
+    for _ in range(levels):
+        result = (result << 1) | (x & 1)
+        x >>= 1
+    return result
+
+
+def literal(value):
+    """Long double constants are not shortened to float by -fsingle-precision-constant."""
+    return "(sample_t)%sL" % repr(float(value))
+
+
+def stage_sizes(levels):
+    """Sizes of the stages after the radix-2 stage of an odd number of levels, as in Fft_transformRadix4."""
+    size = 8 if levels % 2 == 1 else 4
+    sizes = []
+    while size <= (1 << levels):
+        sizes.append(size)
+        size *= 4
+    return sizes
+
+
+def twiddle(m, j, size):
+    angle = 2 * math.pi * ((m * j) % size) / size
+    return math.cos(angle), -math.sin(angle)
+
+
+class BlockWriter:
+    """Writes the stages of one block as straight-line code on local variables."""
+
+    def __init__(self, block):
+        self.lines = []
+        self.count = 0
+        self.real = ["r[%d]" % i for i in range(block)]
+        self.imag = ["i[%d]" % i for i in range(block)]
+        for k in range(block):
+            self.real[k] = self.define("r[%d]" % k)
+            self.imag[k] = self.define("i[%d]" % k)
+
+    def define(self, expression):
+        name = "t%d" % self.count
+        self.count += 1
+        self.lines.append("sample_t %s = %s;" % (name, expression))
+        return name
+
+    def multiply(self, xr, xi, wr, wi):
+        if abs(wr - 1) < 1e-15 and abs(wi) < 1e-15:
+            return xr, xi
+        if abs(wr) < 1e-15 and abs(wi + 1) < 1e-15:  # -i
+            return xi, self.define("-%s" % xr)
+        tr = self.define("%s * %s - %s * %s" % (literal(wr), xr, literal(wi), xi))
+        ti = self.define("%s * %s + %s * %s" % (literal(wr), xi, literal(wi), xr))
+        return tr, ti
+
+    def radix2(self, a, b):
+        re, im = self.real, self.imag
+        sr, si = self.define("%s + %s" % (re[a], re[b])), self.define("%s + %s" % (im[a], im[b]))
+        dr, di = self.define("%s - %s" % (re[a], re[b])), self.define("%s - %s" % (im[a], im[b]))
+        re[a], im[a], re[b], im[b] = sr, si, dr, di
+
+    def radix4(self, i0, q, j, size):
+        re, im = self.real, self.imag
+        i1, i2, i3 = i0 + q, i0 + 2 * q, i0 + 3 * q
+        t1r, t1i = self.multiply(re[i1], im[i1], *twiddle(2, j, size))
+        t2r, t2i = self.multiply(re[i2], im[i2], *twiddle(1, j, size))
+        t3r, t3i = self.multiply(re[i3], im[i3], *twiddle(3, j, size))
+        s0r, s0i = self.define("%s + %s" % (re[i0], t1r)), self.define("%s + %s" % (im[i0], t1i))
+        d0r, d0i = self.define("%s - %s" % (re[i0], t1r)), self.define("%s - %s" % (im[i0], t1i))
+        s1r, s1i = self.define("%s + %s" % (t2r, t3r)), self.define("%s + %s" % (t2i, t3i))
+        d1r, d1i = self.define("%s - %s" % (t2r, t3r)), self.define("%s - %s" % (t2i, t3i))
+        re[i0], im[i0] = self.define("%s + %s" % (s0r, s1r)), self.define("%s + %s" % (s0i, s1i))
+        re[i2], im[i2] = self.define("%s - %s" % (s0r, s1r)), self.define("%s - %s" % (s0i, s1i))
+        # Multiplication of d1 with -i
+        re[i1], im[i1] = self.define("%s + %s" % (d0r, d1i)), self.define("%s - %s" % (d0i, d1r))
+        re[i3], im[i3] = self.define("%s - %s" % (d0r, d1i)), self.define("%s + %s" % (d0i, d1r))
+
+
+def write_tables(out, n):
+    levels = levels_of(n)
+    swaps = [(i, reverse_bits(i, levels)) for i in range(n) if reverse_bits(i, levels) > i]
+    index_type = "uint16_t" if n <= 65536 else "uint32_t"
+    out.write("static const %s fftCodeletSwaps%d[%d][2] = {\n" % (index_type, n, len(swaps)))
+    for k in range(0, len(swaps), 8):
+        out.write("\t" + " ".join("{%d, %d}," % pair for pair in swaps[k:k + 8]) + "\n")
+    out.write("};\n")
+
+    sizes = [size for size in stage_sizes(levels) if size > block_size(levels)]
+    values = []
+    for size in sizes:
+        q = size // 4
+        for m in (1, 2, 3):
+            values += [twiddle(m, j, size)[0] for j in range(q)]
+            values += [twiddle(m, j, size)[1] for j in range(q)]
+    out.write("static const sample_t fftCodeletTwiddles%d[%d] = {\n" % (n, max(len(values), 1)))
+    for k in range(0, len(values), 4):
+        out.write("\t" + " ".join("%s," % literal(v) for v in values[k:k + 4]) + "\n")
+    if not values:
+        out.write("\t0.0,\n")
+    out.write("};\n\n")
+
+
+def block_size(levels):
+    return 8 if levels % 2 == 1 else 16
+
+
+def write_codelet(out, n):
+    levels = levels_of(n)
+    block = block_size(levels)
+    out.write("CODELET_ATTRIBUTES static void CODELET_NAME(fftCodelet%d)(sample_t *restrict real, sample_t *restrict imag) {\n" % n)
+    out.write("\tfor (size_t s = 0; s < sizeof(fftCodeletSwaps%d) / sizeof(fftCodeletSwaps%d[0]); s++) {\n" % (n, n))
+    out.write("\t\tsize_t a = fftCodeletSwaps%d[s][0], b = fftCodeletSwaps%d[s][1];\n" % (n, n))
+    out.write("\t\tsample_t temp = real[a]; real[a] = real[b]; real[b] = temp;\n")
+    out.write("\t\ttemp = imag[a]; imag[a] = imag[b]; imag[b] = temp;\n")
+    out.write("\t}\n")
+
+    writer = BlockWriter(block)
+    if levels % 2 == 1:
+        for a in range(0, block, 2):
+            writer.radix2(a, a + 1)
+    for size in [size for size in stage_sizes(levels) if size <= block]:
+        q = size // 4
+        for start in range(0, block, size):
+            for j in range(q):
+                writer.radix4(start + j, q, j, size)
+    out.write("\tfor (size_t block = 0; block < %d; block += %d) {\n" % (n, block))
+    out.write("\t\tsample_t *restrict r = real + block, *restrict i = imag + block;\n")
+    for line in writer.lines:
+        out.write("\t\t%s\n" % line)
+    for k in range(block):
+        out.write("\t\tr[%d] = %s; i[%d] = %s;\n" % (k, writer.real[k], k, writer.imag[k]))
+    out.write("\t}\n")
+
+    offset = 0
+    for size in [size for size in stage_sizes(levels) if size > block]:
+        q = size // 4
+        out.write("\tfftCodeletStage(real, imag, %d, %d, fftCodeletTwiddles%d + %d);\n" % (n, q, n, offset))
+        offset += 6 * q
+    out.write("}\n\n")
+
+
+def main(argv):
+    sizes = sorted(set(int(arg) for arg in argv[1:]))
+    out = sys.stdout
+    out.write("/* Generated by FFTCodeletGenerator.py for the sizes %s, do not edit. */\n\n" % " ".join(map(str, sizes)))
+    out.write("#ifndef FFT_CODELET_TABLES\n#define FFT_CODELET_TABLES\n\n")
+    out.write("#define FFT_CODELET_SIZES(X) %s\n\n" % " ".join("X(%d)" % n for n in sizes))
+    for n in sizes:
+        write_tables(out, n)
+    out.write("#endif\n\n")
+    for n in sizes:
+        write_codelet(out, n)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,84 @@
+/**
+@file FFTCodelets.c
+The codelets are radix-4 transforms that are specialized for one size when the program is built. The generator
+FFTCodeletGenerator.py writes FFTCodeletKernels.inc with one function per size of CODELET_SIZES in the Makefile,
+the bit reversal and all twiddle factors are constant tables and every loop bound is a constant. Sizes without
+a codelet are transformed by the generic kernels of FFTKernels.c.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the size-specialized fft kernels.
+**/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/CpuFeatures.h"
+#include "../include/FFT.h"
+
+
+/*
+ * One radix-4 stage as in radix4StageScalar. It is inlined into every codelet, such that n, q and the twiddle table
+ * are constants and the compiler unrolls and vectorizes the loops for the instruction set of the codelet.
+ */
+__attribute__((always_inline)) static inline void fftCodeletStage(sample_t *restrict real, sample_t *restrict imag,
+		size_t n, size_t q, const sample_t *restrict tw) {
+	const sample_t *w1r = tw, *w1i = tw + q, *w2r = tw + 2 * q, *w2i = tw + 3 * q, *w3r = tw + 4 * q, *w3i = tw + 5 * q;
+	for (size_t block = 0; block < n; block += 4 * q) {
+		for (size_t j = 0; j < q; j++) {
+			size_t i0 = block + j, i1 = i0 + q, i2 = i1 + q, i3 = i2 + q;
+			sample_t t1r = w2r[j] * real[i1] - w2i[j] * imag[i1];
+			sample_t t1i = w2r[j] * imag[i1] + w2i[j] * real[i1];
+			sample_t t2r = w1r[j] * real[i2] - w1i[j] * imag[i2];
+			sample_t t2i = w1r[j] * imag[i2] + w1i[j] * real[i2];
+			sample_t t3r = w3r[j] * real[i3] - w3i[j] * imag[i3];
+			sample_t t3i = w3r[j] * imag[i3] + w3i[j] * real[i3];
+			sample_t s0r = real[i0] + t1r, s0i = imag[i0] + t1i;
+			sample_t d0r = real[i0] - t1r, d0i = imag[i0] - t1i;
+			sample_t s1r = t2r + t3r, s1i = t2i + t3i;
+			sample_t d1r = t2r - t3r, d1i = t2i - t3i;
+			real[i0] = s0r + s1r;
+			imag[i0] = s0i + s1i;
+			real[i2] = s0r - s1r;
+			imag[i2] = s0i - s1i;
+			// Multiplication of d1 with -i
+			real[i1] = d0r + d1i;
+			imag[i1] = d0i - d1r;
+			real[i3] = d0r - d1i;
+			imag[i3] = d0i + d1r;
+		}
+	}
+}
+
+
+/*
+ * The generated codelets are compiled once for the baseline of the target and once more for AVX2 on x86
+ */
+#define CODELET_NAME(name) name##Generic
+#define CODELET_ATTRIBUTES
+#include "FFTCodeletKernels.inc"
+#undef CODELET_NAME
+#undef CODELET_ATTRIBUTES
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAS_AVX2_CODELETS
+#define CODELET_NAME(name) name##Avx2
+#define CODELET_ATTRIBUTES __attribute__((target("avx2")))
+#include "FFTCodeletKernels.inc"
+#undef CODELET_NAME
+#undef CODELET_ATTRIBUTES
+#endif
+
+
+FftCodelet Fft_getCodelet(size_t n) {
+#if defined(HAS_AVX2_CODELETS)
+	if ((getCpuFeatures() & CPU_FEATURE_AVX2) != 0) {
+#define SELECT_CODELET(size) if (n == size) return fftCodelet##size##Avx2;
+		FFT_CODELET_SIZES(SELECT_CODELET)
+#undef SELECT_CODELET
+		return NULL;
+	}
+#endif
+#define SELECT_CODELET(size) if (n == size) return fftCodelet##size##Generic;
+	FFT_CODELET_SIZES(SELECT_CODELET)
+#undef SELECT_CODELET
+	return NULL;
+}
@@ -0,0 +1,261 @@
+/**
+@file FFTKernels.c
+The radix-4 kernels fuse two radix-2 stages into one pass over the data. Each pass loads and stores every
+element once instead of twice and needs three instead of four complex multiplications per four elements.
+The vectorized variants process consecutive butterflies of a stage in parallel on the split real and
+imaginary arrays. They are compiled into the same binary and the plan selects one of them at runtime.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the radix-4 fft kernels.
+**/
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "../include/CpuFeatures.h"
+#include "../include/FFT.h"
+
+
+/*
+ * The twiddle factors of one radix-4 stage with quarter size q are stored as six consecutive arrays of
+ * length q: w^j, w^2j and w^3j (real and imaginary parts) with w = exp(-2*pi*i/(4*q)).
+ */
+bool Fft_initRadix4Twiddles(FftPlan *plan) {
+	size_t n = plan->n;
+	size_t count = 0;
+	size_t first = (plan->levels % 2 == 1) ? 8 : 4;
+	for (size_t size = first; size <= n; size *= 4)
+		count += 6 * (size / 4);
+	plan->radix4Twiddles = malloc((count + 1) * sizeof(sample_t));
+	if (plan->radix4Twiddles == NULL)
+		return false;
+
+	sample_t *tw = plan->radix4Twiddles;
+	for (size_t size = first; size <= n; size *= 4) {
+		size_t q = size / 4;
+		for (size_t j = 0; j < q; j++) {
+			for (size_t m = 1; m <= 3; m++) {
+				size_t k = (m * j) % size;
+				tw[(2 * m - 2) * q + j] = cos(2 * M_PI * k / size);
+				tw[(2 * m - 1) * q + j] = -sin(2 * M_PI * k / size);
+			}
+		}
+		tw += 6 * q;
+	}
+	return true;
+}
+
+
+static void radix4StageScalar(sample_t real[], sample_t imag[], size_t n, size_t q, const sample_t *tw) {
+	const sample_t *w1r = tw, *w1i = tw + q, *w2r = tw + 2 * q, *w2i = tw + 3 * q, *w3r = tw + 4 * q, *w3i = tw + 5 * q;
+	for (size_t block = 0; block < n; block += 4 * q) {
+		for (size_t j = 0; j < q; j++) {
+			size_t i0 = block + j, i1 = i0 + q, i2 = i1 + q, i3 = i2 + q;
+			sample_t t1r = w2r[j] * real[i1] - w2i[j] * imag[i1];
+			sample_t t1i = w2r[j] * imag[i1] + w2i[j] * real[i1];
+			sample_t t2r = w1r[j] * real[i2] - w1i[j] * imag[i2];
+			sample_t t2i = w1r[j] * imag[i2] + w1i[j] * real[i2];
+			sample_t t3r = w3r[j] * real[i3] - w3i[j] * imag[i3];
+			sample_t t3i = w3r[j] * imag[i3] + w3i[j] * real[i3];
+			sample_t s0r = real[i0] + t1r, s0i = imag[i0] + t1i;
+			sample_t d0r = real[i0] - t1r, d0i = imag[i0] - t1i;
+			sample_t s1r = t2r + t3r, s1i = t2i + t3i;
+			sample_t d1r = t2r - t3r, d1i = t2i - t3i;
+			real[i0] = s0r + s1r;
+			imag[i0] = s0i + s1i;
+			real[i2] = s0r - s1r;
+			imag[i2] = s0i - s1i;
+			// Multiplication of d1 with -i
+			real[i1] = d0r + d1i;
+			imag[i1] = d0i - d1r;
+			real[i3] = d0r - d1i;
+			imag[i3] = d0i + d1r;
+		}
+	}
+}
+
+
+/*
+ * Generates the vectorized version of radix4StageScalar. The stage needs q to be a multiple of the
+ * vector width, smaller stages fall back to the scalar version.
+ */
+#define DEFINE_RADIX4_STAGE(name, attributes, vector, width, load, store, add, sub, mul) \
+attributes static void name(sample_t real[], sample_t imag[], size_t n, size_t q, const sample_t *tw) { \
+	const sample_t *w1r = tw, *w1i = tw + q, *w2r = tw + 2 * q, *w2i = tw + 3 * q, *w3r = tw + 4 * q, *w3i = tw + 5 * q; \
+	for (size_t block = 0; block < n; block += 4 * q) { \
+		for (size_t j = 0; j < q; j += width) { \
+			size_t i0 = block + j, i1 = i0 + q, i2 = i1 + q, i3 = i2 + q; \
+			vector x1r = load(real + i1), x1i = load(imag + i1); \
+			vector x2r = load(real + i2), x2i = load(imag + i2); \
+			vector x3r = load(real + i3), x3i = load(imag + i3); \
+			vector wr = load(w2r + j), wi = load(w2i + j); \
+			vector t1r = sub(mul(wr, x1r), mul(wi, x1i)); \
+			vector t1i = add(mul(wr, x1i), mul(wi, x1r)); \
+			wr = load(w1r + j); wi = load(w1i + j); \
+			vector t2r = sub(mul(wr, x2r), mul(wi, x2i)); \
+			vector t2i = add(mul(wr, x2i), mul(wi, x2r)); \
+			wr = load(w3r + j); wi = load(w3i + j); \
+			vector t3r = sub(mul(wr, x3r), mul(wi, x3i)); \
+			vector t3i = add(mul(wr, x3i), mul(wi, x3r)); \
+			vector x0r = load(real + i0), x0i = load(imag + i0); \
+			vector s0r = add(x0r, t1r), s0i = add(x0i, t1i); \
+			vector d0r = sub(x0r, t1r), d0i = sub(x0i, t1i); \
+			vector s1r = add(t2r, t3r), s1i = add(t2i, t3i); \
+			vector d1r = sub(t2r, t3r), d1i = sub(t2i, t3i); \
+			store(real + i0, add(s0r, s1r)); \
+			store(imag + i0, add(s0i, s1i)); \
+			store(real + i2, sub(s0r, s1r)); \
+			store(imag + i2, sub(s0i, s1i)); \
+			store(real + i1, add(d0r, d1i)); \
+			store(imag + i1, sub(d0i, d1r)); \
+			store(real + i3, sub(d0r, d1i)); \
+			store(imag + i3, add(d0i, d1r)); \
+		} \
+	} \
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#ifdef SINGLE_PRECISION
+#define SSE2_WIDTH 4
+#define AVX2_WIDTH 8
+DEFINE_RADIX4_STAGE(radix4StageSse2, __attribute__((target("sse2"))), __m128, SSE2_WIDTH,
+		_mm_loadu_ps, _mm_storeu_ps, _mm_add_ps, _mm_sub_ps, _mm_mul_ps)
+DEFINE_RADIX4_STAGE(radix4StageAvx2, __attribute__((target("avx2"))), __m256, AVX2_WIDTH,
+		_mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps)
+#else
+#define SSE2_WIDTH 2
+#define AVX2_WIDTH 4
+DEFINE_RADIX4_STAGE(radix4StageSse2, __attribute__((target("sse2"))), __m128d, SSE2_WIDTH,
+		_mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+DEFINE_RADIX4_STAGE(radix4StageAvx2, __attribute__((target("avx2"))), __m256d, AVX2_WIDTH,
+		_mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+#endif
+#endif
+
+/*
+ * NEON on 32 bit ARM has no double precision vectors and needs the compiler flag -mfpu=neon
+ */
+#if defined(SINGLE_PRECISION) && defined(__ARM_NEON)
+#define HAS_NEON_KERNEL
+#define NEON_WIDTH 4
+DEFINE_RADIX4_STAGE(radix4StageNeon, , float32x4_t, NEON_WIDTH,
+		vld1q_f32, vst1q_f32, vaddq_f32, vsubq_f32, vmulq_f32)
+#elif defined(__aarch64__)
+#define HAS_NEON_KERNEL
+#define NEON_WIDTH 2
+DEFINE_RADIX4_STAGE(radix4StageNeon, , float64x2_t, NEON_WIDTH,
+		vld1q_f64, vst1q_f64, vaddq_f64, vsubq_f64, vmulq_f64)
+#endif
+
+
+bool Fft_isKernelSupported(FftKernel kernel) {
+	switch (kernel) {
+		case FFT_KERNEL_RADIX2:
+		case FFT_KERNEL_RADIX4:
+		case FFT_KERNEL_CODELET:
+		case FFT_KERNEL_STOCKHAM:
+			return true;
+#if defined(__x86_64__) || defined(__i386__)
+		case FFT_KERNEL_SSE2:
+			return (getCpuFeatures() & CPU_FEATURE_SSE2) != 0;
+		case FFT_KERNEL_AVX2:
+			return (getCpuFeatures() & CPU_FEATURE_AVX2) != 0;
+#endif
+#if defined(HAS_NEON_KERNEL)
+		case FFT_KERNEL_NEON:
+			return (getCpuFeatures() & CPU_FEATURE_NEON) != 0;
+#endif
+		default:
+			return false;
+	}
+}
+
+
+FftKernel Fft_getBestKernel(void) {
+	static const FftKernel preference[] = {FFT_KERNEL_AVX2, FFT_KERNEL_NEON, FFT_KERNEL_SSE2, FFT_KERNEL_RADIX4};
+	for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+		if (Fft_isKernelSupported(preference[i]))
+			return preference[i];
+	}
+	return FFT_KERNEL_RADIX2;
+}
+
+
+const char *Fft_getKernelName(FftKernel kernel) {
+	switch (kernel) {
+		case FFT_KERNEL_RADIX2: return "radix2";
+		case FFT_KERNEL_RADIX4: return "radix4";
+		case FFT_KERNEL_SSE2: return "sse2";
+		case FFT_KERNEL_AVX2: return "avx2";
+		case FFT_KERNEL_NEON: return "neon";
+		case FFT_KERNEL_CODELET: return "codelet";
+		case FFT_KERNEL_STOCKHAM: return "stockham";
+		default: return "unknown";
+	}
+}
+
+
+bool Fft_transformRadix4(const FftPlan *plan, sample_t real[], sample_t imag[]) {
+	size_t n = plan->n;
+	Fft_bitReverse(plan, real, imag);
+
+	// An odd number of levels needs one radix-2 stage, which has no twiddle factors
+	size_t size = 4;
+	if (plan->levels % 2 == 1) {
+		for (size_t i = 0; i < n; i += 2) {
+			sample_t tr = real[i + 1], ti = imag[i + 1];
+			real[i + 1] = real[i] - tr;
+			imag[i + 1] = imag[i] - ti;
+			real[i] += tr;
+			imag[i] += ti;
+		}
+		size = 8;
+	}
+
+	const sample_t *tw = plan->radix4Twiddles;
+	for (; size <= n; size *= 4) {
+		size_t q = size / 4;
+		switch (plan->kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+			case FFT_KERNEL_SSE2:
+				if (q % SSE2_WIDTH == 0) {
+					radix4StageSse2(real, imag, n, q, tw);
+					break;
+				}
+				radix4StageScalar(real, imag, n, q, tw);
+				break;
+			case FFT_KERNEL_AVX2:
+				if (q % AVX2_WIDTH == 0) {
+					radix4StageAvx2(real, imag, n, q, tw);
+					break;
+				}
+				radix4StageScalar(real, imag, n, q, tw);
+				break;
+#endif
+#if defined(HAS_NEON_KERNEL)
+			case FFT_KERNEL_NEON:
+				if (q % NEON_WIDTH == 0) {
+					radix4StageNeon(real, imag, n, q, tw);
+					break;
+				}
+				radix4StageScalar(real, imag, n, q, tw);
+				break;
+#endif
+			default:
+				radix4StageScalar(real, imag, n, q, tw);
+				break;
+		}
+		tw += 6 * q;
+		if (size > SIZE_MAX / 4)  // Prevent overflow in 'size *= 4'
+			break;
+	}
+	return true;
+}
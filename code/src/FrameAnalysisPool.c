@@ -0,0 +1,267 @@
+/**
+@file FrameAnalysisPool.c
+The submitting thread stages every hop into the slot of the queue of the next analysis thread in turn, such that the threads need no
+shared queue and the frames of a thread are queued in order. The analysis threads only share the reorder buffer of the results, in
+which each of them writes the slots of its own sequence numbers.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the pool of threads that analyze the frames of the hops in parallel.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/FrameAnalysisPool.h"
+#include "../include/AudioPreProcessing.h"
+#include "../include/HelperFunctions.h"
+#include "../include/NoteBank.h"
+#include "../include/RingBuffer.h"
+#include "../include/fft_engine.h"
+
+/**
+@brief This function returns the time between two time stamps in milliseconds.
+@param start the earlier time stamp
+@param end the later time stamp
+@return elapsedTime the difference in milliseconds
+**/
+static double getElapsedTime(struct timespec *start, struct timespec *end){
+  return (end->tv_sec - start->tv_sec)*1000.0 + (end->tv_nsec - start->tv_nsec)/1000000.0;
+}
+
+/**
+@brief This function analyzes the frame of a hop as the melody modes do and finds the loudest frequency.
+@param worker the analysis thread
+@param job the frame of the hop
+@param spectralFrame receives the loudest frequency
+**/
+static void analyzeFrameJob(FrameAnalysisWorker *worker, const FrameJob *job, SpectralFrame *spectralFrame){
+  FrameAnalysisPool *pool = worker->pool;
+  struct timespec start_t, current_t;
+  spectralFrame->captureTime = job->captureTime;
+  spectralFrame->isSkipped = job->isSkipped;
+  if (job->isSkipped) {
+    return;
+  }
+  clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+  if (pool->useNoteBank || pool->useConstantQ) {
+    if (pool->useNoteBank) {
+      analyzeNoteBank(&worker->noteBank,job->frame,worker->amps);
+    } else {
+      analyzeConstantQ(&worker->constantQ,job->frame,worker->amps);
+    }
+    clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+    applyFrequencyBandpass(worker->amps,pool->sampleSize,pool->sampleRate,LOW_FREQUENCY,HIGH_FREQUENCY);
+    spectralFrame->frequencyBin = getFrequencyBin(worker->amps,pool->sampleSize);
+    spectralFrame->frequency = pool->useConstantQ ? getConstantQFrequency(&worker->constantQ,spectralFrame->frequencyBin) : spectralFrame->frequencyBin * pool->sampleRate/pool->sampleSize;
+    spectralFrame->position = spectralFrame->frequency * pool->sampleSize/pool->sampleRate;
+    spectralFrame->isFractional = pool->useConstantQ;
+  } else {
+    SpectralPeak peak;
+    forward_fft_engine(worker->fftEngine,job->frame,worker->outReal,worker->outImag);
+    clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+    findSpectralPeak(&peak,worker->outReal,worker->outImag,pool->minBin,pool->maxBin,pool->sampleSize);
+    spectralFrame->frequencyBin = peak.bin;
+    spectralFrame->position = pool->interpolatePeak ? getPeakPosition(&peak) : peak.bin;
+    spectralFrame->frequency = spectralFrame->position * pool->sampleRate/pool->sampleSize;
+    spectralFrame->isFractional = pool->interpolatePeak;
+  }
+  worker->fftTime += getElapsedTime(&start_t, &current_t);
+}
+
+/**
+@brief This function is the entry point for an analysis thread.
+It analyzes the frames of its queue until the queue is closed and read.
+@param arg the FrameAnalysisWorker of the thread
+**/
+static void *frame_analysis_entry_point(void *arg){
+  FrameAnalysisWorker *worker = (FrameAnalysisWorker *)arg;
+  struct timespec start_t, current_t;
+  FrameJob *job;
+  while ((job = (FrameJob *)waitRingSlot(&worker->jobs)) != NULL) {
+    clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+    size_t sequence = job->sequence;
+    SpectralFrame *spectralFrame = (SpectralFrame *)getReorderSlot(&worker->pool->results, sequence);
+    analyzeFrameJob(worker, job, spectralFrame);
+    releaseRingSlot(&worker->jobs);
+    publishReorderSlot(&worker->pool->results, sequence);
+    clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+    worker->analysisTime += getElapsedTime(&start_t, &current_t);
+    worker->numFrames++;
+  }
+  return NULL;
+}
+
+/**
+@brief This function allocates the analyzer and the queue of an analysis thread.
+@param worker the analysis thread
+@param config the configuration of the frame loop
+@return isSuccess 1 if the analyzer was initialized, 0 otherwise
+**/
+static int initFrameAnalysisWorker(FrameAnalysisWorker *worker, const RunTimeInformation *config){
+  FrameAnalysisPool *pool = worker->pool;
+  int numFrequencyBins = pool->sampleSize/2 + 1;
+  worker->amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  worker->outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  worker->outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  if (worker->amps == NULL || worker->outReal == NULL || worker->outImag == NULL) {
+    return 0;
+  }
+  if (!initRingBuffer(&worker->jobs, FRAME_ANALYSIS_QUEUE_SIZE, sizeof(FrameJob) + pool->sampleSize * sizeof(sample_t))) {
+    return 0;
+  }
+  if (pool->useNoteBank) {
+    return initNoteBank(&worker->noteBank, config->spectralAnalyzer, config->sampleSize, config->stepSize, pool->sampleRate, config->tuningPitch, config->noteBankNeighbours, config->windowingFunction, config->kaiserBeta);
+  }
+  if (pool->useConstantQ) {
+    return initConstantQTransform(&worker->constantQ, config->fftEngine, config->sampleSize, config->stepSize, pool->sampleRate, config->tuningPitch, config->constantQBinsPerOctave);
+  }
+  return open_fft_engine(&worker->fftEngine, config->fftEngine, config->sampleSize);
+}
+
+/**
+@brief This function frees memory space taken by an analysis thread that ended or was never started.
+@param worker the analysis thread
+**/
+static void freeFrameAnalysisWorker(FrameAnalysisWorker *worker){
+  FrameAnalysisPool *pool = worker->pool;
+  free(worker->amps);
+  free(worker->outReal);
+  free(worker->outImag);
+  freeRingBuffer(&worker->jobs);
+  if (pool->useNoteBank && worker->noteBank.bins != NULL) {
+    freeNoteBank(&worker->noteBank);
+  }
+  if (pool->useConstantQ && worker->constantQ.kernel != NULL) {
+    freeConstantQTransform(&worker->constantQ);
+  }
+  if (worker->fftEngine != NULL) {
+    close_fft_engine(worker->fftEngine);
+  }
+}
+
+int initFrameAnalysisPool(FrameAnalysisPool *pool, const RunTimeInformation *config, double sampleRate, int numWorkers, int firstCore){
+  memset(pool, 0, sizeof(FrameAnalysisPool));
+  pool->sampleSize = config->sampleSize;
+  pool->sampleRate = sampleRate;
+  pool->useConstantQ = strcmp(config->spectralAnalyzer, "constant-q") == 0;
+  pool->useNoteBank = !pool->useConstantQ && strcmp(config->spectralAnalyzer, "fft") != 0;
+  pool->interpolatePeak = !pool->useNoteBank && !pool->useConstantQ && config->peakInterpolation;
+  getBandpassBins(&pool->minBin, &pool->maxBin, config->sampleSize, sampleRate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  //the cores below firstCore belong to the pinned threads of the pipeline, the analysis threads only use the others
+  long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+  int numFreeCores = numCores > 0 ? (int)numCores - (firstCore > 0 ? firstCore : 0) : 0;
+  if (numWorkers <= 0) {
+    numWorkers = numFreeCores > 1 ? numFreeCores : 1;
+  }
+  //the queues of the threads are aligned to cache lines, such that the threads do not share the lines of their indices
+  void *workers = NULL;
+  if (posix_memalign(&workers, CACHE_LINE_SIZE, numWorkers * sizeof(FrameAnalysisWorker)) != 0) {
+    printf("%s\n", "Frame analysis pool could not be allocated!");
+    return 0;
+  }
+  pool->workers = (FrameAnalysisWorker *)workers;
+  memset(pool->workers, 0, numWorkers * sizeof(FrameAnalysisWorker));
+  for (int i = 0; i < numWorkers; i++) {
+    FrameAnalysisWorker *worker = &pool->workers[i];
+    worker->pool = pool;
+    pool->numWorkers = i + 1;
+    if (!initFrameAnalysisWorker(worker, config)) {
+      printf("%s\n", "Frame analysis thread could not be initialized!");
+      freeFrameAnalysisPool(pool);
+      return 0;
+    }
+    int isStateful = pool->useConstantQ || (pool->useNoteBank && worker->noteBank.analyzer == NOTE_BANK_SLIDING_DFT);
+    if (isStateful) {
+      break;
+    }
+  }
+  if (!initReorderBuffer(&pool->results, 2 * pool->numWorkers * FRAME_ANALYSIS_QUEUE_SIZE, sizeof(SpectralFrame))) {
+    freeFrameAnalysisPool(pool);
+    return 0;
+  }
+  initFrameStager(&pool->stager, config->sampleSize, config->stepSize, getWindowingFunction(config->windowingFunction), config->kaiserBeta);
+  pool->isStarted = 1;
+  for (int i = 0; i < pool->numWorkers; i++) {
+    FrameAnalysisWorker *worker = &pool->workers[i];
+    pthread_create(&worker->thread, NULL, frame_analysis_entry_point, worker);
+    if (firstCore >= 0 && numFreeCores > 0) {
+      pinThreadToCore(worker->thread, firstCore + i % numFreeCores);
+    }
+  }
+  return 1;
+}
+
+/**
+The goertzel analyzer and the constant q transform take the unwindowed frame, the sliding dft only reads its last stepSize samples.
+**/
+void submitFrame(FrameAnalysisPool *pool, const short *samples, double captureTime, int isSkipped){
+  struct timespec start_t, current_t;
+  size_t sequence = waitReorderSequence(&pool->results);
+  FrameAnalysisWorker *worker = &pool->workers[sequence % pool->numWorkers];
+  FrameJob *job = (FrameJob *)waitFreeRingSlot(&worker->jobs);
+  job->sequence = sequence;
+  job->captureTime = captureTime;
+  job->isSkipped = isSkipped;
+  int needsHistory = pool->useNoteBank || pool->useConstantQ;
+  clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+  const sample_t *history = stageFrame(&pool->stager, samples, needsHistory || isSkipped ? NULL : job->frame);
+  if (needsHistory && !isSkipped) {
+    memcpy(job->frame, history, pool->sampleSize * sizeof(sample_t));
+  }
+  clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+  pool->stagingTime += getElapsedTime(&start_t, &current_t);
+  publishRingSlot(&worker->jobs);
+}
+
+int isFrameAnalysisPoolFull(FrameAnalysisPool *pool){
+  return isReorderBufferFull(&pool->results);
+}
+
+const SpectralFrame *peekSpectralFrame(FrameAnalysisPool *pool){
+  return (const SpectralFrame *)peekReorderSlot(&pool->results);
+}
+
+const SpectralFrame *waitSpectralFrame(FrameAnalysisPool *pool){
+  return (const SpectralFrame *)waitReorderSlot(&pool->results);
+}
+
+void releaseSpectralFrame(FrameAnalysisPool *pool){
+  releaseReorderSlot(&pool->results);
+}
+
+void closeFrameAnalysisPool(FrameAnalysisPool *pool){
+  for (int i = 0; i < pool->numWorkers; i++) {
+    closeRingBuffer(&pool->workers[i].jobs);
+  }
+  closeReorderBuffer(&pool->results);
+  for (int i = 0; pool->isStarted && i < pool->numWorkers; i++) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  pool->isStarted = 0;
+}
+
+void getFrameAnalysisTimes(const FrameAnalysisPool *pool, double *stageTime, double *analysisTime, double *fftTime){
+  *stageTime = 0;
+  *analysisTime = 0;
+  *fftTime = 0;
+  for (int i = 0; i < pool->numWorkers; i++) {
+    if (pool->workers[i].analysisTime > *stageTime) {
+      *stageTime = pool->workers[i].analysisTime;
+    }
+    *analysisTime += pool->workers[i].analysisTime;
+    *fftTime += pool->workers[i].fftTime;
+  }
+}
+
+void freeFrameAnalysisPool(FrameAnalysisPool *pool){
+  for (int i = 0; i < pool->numWorkers; i++) {
+    freeFrameAnalysisWorker(&pool->workers[i]);
+  }
+  free(pool->workers);
+  freeReorderBuffer(&pool->results);
+  freeFrameStager(&pool->stager);
+  pool->workers = NULL;
+  pool->numWorkers = 0;
+}
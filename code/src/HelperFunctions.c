@@ -8,6 +8,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include "../include/HelperFunctions.h"
 
@@ -15,6 +19,50 @@ void msleep(int d){
     usleep(d*1000);
 }
 
+/**
+The kernel only puts the thread to sleep if the int still has the expected value, a wake up between the check of the caller
+and the system call is not lost.
+@see https://man7.org/linux/man-pages/man2/futex.2.html
+**/
+void futexWait(int *address, int expected){
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void futexWake(int *address){
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+int getFlag(int *flag){
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+}
+
+void setFlag(int *flag, int value){
+    __atomic_store_n(flag, value, __ATOMIC_RELEASE);
+    futexWake(flag);
+}
+
+void waitFlag(int *flag, int value){
+    int current;
+    while ((current = getFlag(flag)) != value) {
+        futexWait(flag, current);
+    }
+}
+
+int pinThreadToCore(pthread_t thread, int core){
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numCores < 1) {
+        return 0;
+    }
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core % numCores, &cores);
+    if (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cores) != 0) {
+        printf("Thread could not be pinned to core %ld!\n", core % numCores);
+        return 0;
+    }
+    return 1;
+}
+
 void *copyArray(const void *src, size_t n) {
   void *dest = malloc(n);
 	if (n > 0 && dest != NULL)
@@ -22,8 +70,8 @@ void *copyArray(const void *src, size_t n) {
 	return dest;
 }
 
-void shiftWrite(double *arr,short *buff,int arrSize, int buffSize){
-  memcpy(arr, arr+buffSize, arrSize*sizeof(double)-buffSize*sizeof(double));
+void shiftWrite(sample_t *arr,short *buff,int arrSize, int buffSize){
+  memcpy(arr, arr+buffSize, arrSize*sizeof(sample_t)-buffSize*sizeof(sample_t));
   for (int i = 0; i < buffSize; i++) {
     arr[(arrSize-buffSize) + i] = (float)buff[i] / 32768.0f;
   }
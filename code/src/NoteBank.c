@@ -0,0 +1,278 @@
+/**
+@file NoteBank.c
+The spectrum is only evaluated at the bins of the musical notes. For a few dozen bins this is cheaper than a fft of the whole frame,
+especially with the sliding dft at small step sizes, because its cost only grows with the number of new samples.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the goertzel and sliding dft note bank.
+@see https://en.wikipedia.org/wiki/Goertzel_algorithm
+@see https://en.wikipedia.org/wiki/Sliding_DFT
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../include/NoteBank.h"
+#include "../include/AudioPreProcessing.h"
+
+#define NOTE_BANK_NUM_OCTAVES 6         ///< octaves of the notes, the same as in getBins
+#define NOTE_BANK_NOTES_PER_OCTAVE 12   ///< half steps per octave
+#define NOTE_BANK_RESYNC_FRAMES 64      ///< the sliding dft is recomputed from its history after this many frame lengths to bound the rounding error
+
+/**
+@brief Cosine sum windows a0 - a1 cos(2 pi n/N) + a2 cos(4 pi n/N) - ... that the sliding dft can apply in the frequency domain.
+**/
+static const struct {
+  int numTerms;
+  double terms[5];
+} cosineSumWindows[] = {
+  {1, {1.0}},                                                       //rectangle
+  {2, {0.5, 0.5}},                                                  //hann
+  {2, {0.54, 0.46}},                                                //hamming
+  {3, {7938.0/18608.0, 9240.0/18608.0, 1430.0/18608.0}},            //blackman-exact
+  {4, {0.355768, 0.487396, 0.144232, 0.012604}},                    //nuttall
+  {4, {0.3635819, 0.4891775, 0.1365995, 0.0106411}},                //blackman-nuttall
+  {4, {0.35875, 0.48829, 0.14128, 0.01168}},                        //blackman-harris
+  {5, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368}}, //flattop
+  {3, {1.0, 4.0/3.0, 1.0/3.0}},                                     //rife-vincent
+};
+
+/**
+The window is identified by its coefficients, such that every name that applyWindowingFunction maps to a cosine sum is found.
+**/
+static int findCosineSumWindow(NoteBank *bank){
+  int N = bank->sampleSize;
+  for (size_t w = 0; w < sizeof(cosineSumWindows)/sizeof(cosineSumWindows[0]); w++) {
+    int isMatch = 1;
+    for (int n = 0; n < N && isMatch; n++) {
+      double coefficient = 0;
+      for (int m = 0; m < cosineSumWindows[w].numTerms; m++) {
+        coefficient += (m % 2 ? -1 : 1) * cosineSumWindows[w].terms[m] * cos(2 * M_PI * m * n / N);
+      }
+      isMatch = fabs(coefficient - bank->window[n]) < 1e-5;
+    }
+    if (isMatch) {
+      bank->numWindowTerms = cosineSumWindows[w].numTerms;
+      memcpy(bank->windowTerms, cosineSumWindows[w].terms, sizeof(bank->windowTerms));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+Bins outside of 0..N/2 are mirrored, the spectrum of real data fulfills X[-k] = X[N-k] = conj(X[k]).
+**/
+static int reflectBin(int bin, int sampleSize, int *isConjugate){
+  *isConjugate = 0;
+  if (bin < 0) {
+    bin = -bin;
+    *isConjugate = 1;
+  }
+  if (bin > sampleSize/2) {
+    bin = sampleSize - bin;
+    *isConjugate = !*isConjugate;
+  }
+  return bin;
+}
+
+/**
+The dft of every evaluated bin is calculated directly from the history, with the oldest sample first.
+**/
+static void resyncSlidingDft(NoteBank *bank){
+  int N = bank->sampleSize;
+  for (int b = 0; b < bank->numBins; b++) {
+    double coefficient = bank->coefficients[b];
+    double s1 = 0;
+    double s2 = 0;
+    for (int n = 0; n < N; n++) {
+      double s0 = bank->history[(bank->historyPos + n) % N] + coefficient * s1 - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    bank->stateReal[b] = bank->twiddleReal[b] * s1 - s2;
+    bank->stateImag[b] = bank->twiddleImag[b] * s1;
+  }
+  bank->samplesSinceSync = 0;
+}
+
+/**
+Every new sample replaces the oldest one: S[k] = (S[k] + x_new - x_old) * e^(2 pi i k/N). The loop over the bins is the inner one
+such that it can be vectorized.
+**/
+static void updateSlidingDft(NoteBank *bank, const sample_t *samples, int count){
+  int N = bank->sampleSize;
+  for (int n = 0; n < count; n++) {
+    double delta = (double)samples[n] - bank->history[bank->historyPos];
+    bank->history[bank->historyPos] = samples[n];
+    bank->historyPos = bank->historyPos + 1 == N ? 0 : bank->historyPos + 1;
+    for (int b = 0; b < bank->numBins; b++) {
+      double real = bank->stateReal[b] + delta;
+      double imag = bank->stateImag[b];
+      bank->stateReal[b] = real * bank->twiddleReal[b] - imag * bank->twiddleImag[b];
+      bank->stateImag[b] = real * bank->twiddleImag[b] + imag * bank->twiddleReal[b];
+    }
+  }
+  bank->samplesSinceSync += count;
+  if (bank->samplesSinceSync >= (long)NOTE_BANK_RESYNC_FRAMES * N) {
+    resyncSlidingDft(bank);
+  }
+}
+
+/**
+The window is a convolution in the frequency domain: X_w[k] = a0 S[k] + sum_m (-1)^m a_m/2 (S[k-m] + S[k+m]).
+**/
+static void analyzeSlidingDft(NoteBank *bank, sample_t *amps){
+  for (int o = 0; o < bank->numOutputBins; o++) {
+    int bin = bank->outputBins[o];
+    double real = 0;
+    double imag = 0;
+    for (int m = 1 - bank->numWindowTerms; m < bank->numWindowTerms; m++) {
+      int isConjugate;
+      int slot = bank->binSlots[reflectBin(bin + m, bank->sampleSize, &isConjugate)];
+      double term = (m == 0 ? 1.0 : 0.5) * ((m % 2) ? -1 : 1) * bank->windowTerms[abs(m)];
+      real += term * bank->stateReal[slot];
+      imag += term * (isConjugate ? -bank->stateImag[slot] : bank->stateImag[slot]);
+    }
+    amps[bin] = (sample_t)(real*real + imag*imag);
+  }
+}
+
+/**
+Four bins are calculated in one pass over the frame, their recurrences are independent and keep the pipeline busy.
+The power of a bin is s1^2 + s2^2 - c s1 s2 with the last two values of the recurrence s = x + c s1 - s2.
+**/
+static void analyzeGoertzel(NoteBank *bank, const sample_t *frame, sample_t *amps){
+  int N = bank->sampleSize;
+  double power[4];
+  for (int b = 0; b < bank->numBins; b += 4) {
+    int numGroupBins = bank->numBins - b < 4 ? bank->numBins - b : 4;
+    double c[4] = {0, 0, 0, 0};
+    double s1[4] = {0, 0, 0, 0};
+    double s2[4] = {0, 0, 0, 0};
+    for (int i = 0; i < numGroupBins; i++) {
+      c[i] = bank->coefficients[b + i];
+    }
+    for (int n = 0; n < N; n++) {
+      double x = frame[n] * bank->window[n];
+      for (int i = 0; i < 4; i++) {
+        double s0 = x + c[i] * s1[i] - s2[i];
+        s2[i] = s1[i];
+        s1[i] = s0;
+      }
+    }
+    for (int i = 0; i < numGroupBins; i++) {
+      power[i] = s1[i]*s1[i] + s2[i]*s2[i] - c[i]*s1[i]*s2[i];
+      amps[bank->bins[b + i]] = (sample_t)fmax(power[i], 0.0);
+    }
+  }
+}
+
+/**
+The note bins are calculated in the same way as in getBins, such that the transcription finds its bins filled.
+**/
+int initNoteBank(NoteBank *bank, char *analyzerName, int sampleSize, int stepSize, double sampleRate, double tuningPitch, int numNeighbours, char *windowingFunctionName, double kaiserBeta){
+  int analyzer;
+  if (strcmp(analyzerName, "goertzel") == 0) {
+    analyzer = NOTE_BANK_GOERTZEL;
+  } else if (strcmp(analyzerName, "sliding-dft") == 0) {
+    analyzer = NOTE_BANK_SLIDING_DFT;
+  } else {
+    fprintf(stderr, "unknown note bank analyzer %s!\n", analyzerName);
+    return 0;
+  }
+  int N = sampleSize;
+  int maxBin = N/2;
+  memset(bank, 0, sizeof(NoteBank));
+  bank->sampleSize = N;
+  bank->stepSize = stepSize;
+  bank->window = (sample_t *)malloc(N * sizeof(sample_t));
+  memcpy(bank->window, getWindowCoefficients(getWindowingFunction(windowingFunctionName), N, kaiserBeta), N * sizeof(sample_t));
+  if (analyzer == NOTE_BANK_SLIDING_DFT && !findCosineSumWindow(bank)) {
+    printf("The %s window is no cosine sum window, the goertzel analyzer is used instead of the sliding dft.\n", windowingFunctionName);
+    analyzer = NOTE_BANK_GOERTZEL;
+  }
+  bank->analyzer = analyzer;
+  int spread = analyzer == NOTE_BANK_SLIDING_DFT ? bank->numWindowTerms - 1 : 0;
+
+  char *isEvaluated = (char *)calloc(maxBin + 1, sizeof(char));
+  char *isOutput = (char *)calloc(maxBin + 1, sizeof(char));
+  double basicFrequencies[NOTE_BANK_NOTES_PER_OCTAVE];
+  for (int i = 0; i < NOTE_BANK_NOTES_PER_OCTAVE; i++) {
+    basicFrequencies[i] = tuningPitch * pow(pow(2.0,1.0/12.0),i-9) * pow(2.0,(double)(0-3));
+  }
+  for (int i = 0; i < NOTE_BANK_NUM_OCTAVES; i++) {
+    for (int j = 0; j < NOTE_BANK_NOTES_PER_OCTAVE; j++) {
+      double freq = basicFrequencies[j] * pow(2.0,i);
+      int noteBin = (int)floor((freq * N)/sampleRate);
+      if (noteBin > maxBin) {
+        continue;
+      }
+      for (int d = -(numNeighbours + spread); d <= numNeighbours + spread; d++) {
+        int isConjugate;
+        int bin = reflectBin(noteBin + d, N, &isConjugate);
+        isEvaluated[bin] = 1;
+        if (abs(d) <= numNeighbours && noteBin + d >= 0 && noteBin + d <= maxBin) {
+          isOutput[bin] = 1;
+        }
+      }
+    }
+  }
+
+  bank->binSlots = (int *)malloc((maxBin + 1) * sizeof(int));
+  for (int k = 0; k <= maxBin; k++) {
+    bank->binSlots[k] = isEvaluated[k] ? bank->numBins++ : -1;
+    bank->numOutputBins += isOutput[k];
+  }
+  bank->bins = (int *)malloc(bank->numBins * sizeof(int));
+  bank->outputBins = (int *)malloc(bank->numOutputBins * sizeof(int));
+  bank->coefficients = (double *)malloc(bank->numBins * sizeof(double));
+  bank->twiddleReal = (double *)malloc(bank->numBins * sizeof(double));
+  bank->twiddleImag = (double *)malloc(bank->numBins * sizeof(double));
+  bank->stateReal = (double *)calloc(bank->numBins, sizeof(double));
+  bank->stateImag = (double *)calloc(bank->numBins, sizeof(double));
+  bank->history = (sample_t *)calloc(N, sizeof(sample_t));
+  int numOutputBins = 0;
+  for (int k = 0; k <= maxBin; k++) {
+    if (isEvaluated[k]) {
+      int slot = bank->binSlots[k];
+      double omega = 2 * M_PI * k / N;
+      bank->bins[slot] = k;
+      bank->coefficients[slot] = 2 * cos(omega);
+      bank->twiddleReal[slot] = cos(omega);
+      bank->twiddleImag[slot] = sin(omega);
+    }
+    if (isOutput[k]) {
+      bank->outputBins[numOutputBins++] = k;
+    }
+  }
+  free(isEvaluated);
+  free(isOutput);
+  return 1;
+}
+
+/**
+The sliding dft only consumes the stepSize new samples at the end of the frame, the goertzel analyzer the whole frame.
+**/
+void analyzeNoteBank(NoteBank *bank, const sample_t *inputReal, sample_t *amps){
+  if (bank->analyzer == NOTE_BANK_SLIDING_DFT) {
+    updateSlidingDft(bank, inputReal + bank->sampleSize - bank->stepSize, bank->stepSize);
+    analyzeSlidingDft(bank, amps);
+  } else {
+    analyzeGoertzel(bank, inputReal, amps);
+  }
+}
+
+void freeNoteBank(NoteBank *bank){
+  free(bank->bins);
+  free(bank->outputBins);
+  free(bank->binSlots);
+  free(bank->coefficients);
+  free(bank->twiddleReal);
+  free(bank->twiddleImag);
+  free(bank->stateReal);
+  free(bank->stateImag);
+  free(bank->window);
+  free(bank->history);
+}
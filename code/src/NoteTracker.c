@@ -0,0 +1,69 @@
+/**
+@file NoteTracker.c
+The frame loops detect a midi note for every hop. Single hops with a different note or without a note, e.g. at the attack of a note
+or in a short dip of its loudness, would split the note. The note tracker only accepts a change after it lasted for some hops and
+then dates it back to the first of those hops.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the note state machine with onset and offset hysteresis.
+**/
+#include <stdlib.h>
+#include <math.h>
+
+#include "../include/NoteTracker.h"
+
+void initNoteTracker(NoteTracker *tracker, double hopDuration){
+  tracker->onsetHops = (int)ceil(NOTE_ONSET_TIME / hopDuration);
+  tracker->offsetHops = (int)ceil(NOTE_OFFSET_TIME / hopDuration);
+  tracker->onsetHops = tracker->onsetHops < 1 ? 1 : tracker->onsetHops;
+  tracker->offsetHops = tracker->offsetHops < 1 ? 1 : tracker->offsetHops;
+  tracker->note = NO_MIDI_NOTE;
+  tracker->frequency = 0;
+  tracker->onsetTime = 0;
+  tracker->candidateNote = NO_MIDI_NOTE;
+  tracker->candidateFrequency = 0;
+  tracker->candidateTime = 0;
+  tracker->candidateHops = 0;
+}
+
+/**
+A hop with the current note discards the candidate. A hop with another note either continues the candidate or starts a new one.
+Once the candidate lasted long enough, the current note is finished at the first hop of the candidate, which becomes the current note.
+**/
+int updateNoteTracker(NoteTracker *tracker, int midiNote, double frequency, double time, NoteEvent *event){
+  if (midiNote == tracker->note) {
+    tracker->candidateHops = 0;
+    return 0;
+  }
+  if (tracker->candidateHops == 0 || midiNote != tracker->candidateNote) {
+    tracker->candidateNote = midiNote;
+    tracker->candidateFrequency = frequency;
+    tracker->candidateTime = time;
+    tracker->candidateHops = 0;
+  }
+  tracker->candidateHops++;
+  if (tracker->candidateHops < (midiNote == NO_MIDI_NOTE ? tracker->offsetHops : tracker->onsetHops)) {
+    return 0;
+  }
+  event->midiNote = tracker->note;
+  event->frequency = tracker->frequency;
+  event->onsetTime = tracker->onsetTime;
+  event->duration = tracker->candidateTime - tracker->onsetTime;
+  tracker->note = tracker->candidateNote;
+  tracker->frequency = tracker->candidateFrequency;
+  tracker->onsetTime = tracker->candidateTime;
+  tracker->candidateHops = 0;
+  return event->duration > 0;
+}
+
+int finishNoteTracker(NoteTracker *tracker, double time, NoteEvent *event){
+  event->midiNote = tracker->note;
+  event->frequency = tracker->frequency;
+  event->onsetTime = tracker->onsetTime;
+  event->duration = time - tracker->onsetTime;
+  tracker->note = NO_MIDI_NOTE;
+  tracker->frequency = 0;
+  tracker->onsetTime = time;
+  tracker->candidateHops = 0;
+  return event->duration > 0;
+}
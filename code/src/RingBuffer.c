@@ -0,0 +1,343 @@
+/**
+@file RingBuffer.c
+The producer only writes head and the consumer only writes tail. A slot is handed over by a store of the index
+with release semantics after the slot was written and a load with acquire semantics before the slot is read. Both threads keep
+a copy of the index of the other thread and only load it again when the copy says that the ring is full or empty, such that the
+cache line of the other thread is rarely touched.
+A ring that drops its oldest slots is also shared at the tail, the consumer claims a slot and the producer drops one with a compare and
+swap of tail, such that a slot is either read or dropped. The producer reuses the memory of a slot only after released passed it.
+A thread that has to wait announces it in a flag, checks the ring again and sleeps on the event counter of the other thread. The
+other thread checks the flag after each handover and only then advances the counter and wakes it. Both sides order the flag and the
+index with a full fence, such that either the sleeping thread sees the new index or the other thread sees the flag.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the single producer single consumer ring of preallocated slots.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/RingBuffer.h"
+#include "../include/HelperFunctions.h"
+
+/**
+@brief This function returns the time of the monotonic clock in nanoseconds.
+@return time the nanoseconds
+**/
+static long long getMonotonicNanoseconds(void){
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+  return time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+/**
+@brief This function wakes the other thread after a handover if it announced to wait.
+@param waiting the flag of the other thread
+@param event the event counter the other thread sleeps on
+@param wakeTime receives the time of the wake up call, NULL if it is not measured
+**/
+static void wakeWaitingThread(int *waiting, int *event, long long *wakeTime){
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(waiting, __ATOMIC_RELAXED)) {
+    if (wakeTime != NULL) {
+      __atomic_store_n(wakeTime, getMonotonicNanoseconds(), __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(event, 1, __ATOMIC_SEQ_CST);
+    futexWake(event);
+  }
+}
+
+int initRingBuffer(RingBuffer *ring, size_t minSlots, size_t slotBytes){
+  memset(ring, 0, sizeof(RingBuffer));
+  ring->numSlots = 1;
+  while (ring->numSlots < minSlots) {
+    ring->numSlots <<= 1;
+  }
+  ring->mask = ring->numSlots - 1;
+  ring->slotBytes = slotBytes;
+  ring->slots = (char *)calloc(ring->numSlots, slotBytes);
+  if (ring->slots == NULL) {
+    printf("%s\n", "Ring buffer could not be allocated!");
+    return 0;
+  }
+  return 1;
+}
+
+int initAudioRingBuffer(RingBuffer *ring, size_t minSlots, size_t slotSize){
+  if (!initRingBuffer(ring, minSlots, sizeof(AudioCapturePoint))) {
+    return 0;
+  }
+  short *samples = (short *)calloc(ring->numSlots * slotSize, sizeof(short));
+  if (samples == NULL) {
+    printf("%s\n", "Audio ring buffer could not be allocated!");
+    freeRingBuffer(ring);
+    return 0;
+  }
+  ring->data = samples;
+  AudioCapturePoint *slots = (AudioCapturePoint *)ring->slots;
+  for (size_t i = 0; i < ring->numSlots; i++) {
+    slots[i].arr = samples + i * slotSize;
+    slots[i].size = slotSize;
+    slots[i].pos = slotSize;
+  }
+  return 1;
+}
+
+void setRingDropOldest(RingBuffer *ring){
+  __atomic_store_n(&ring->dropOldest, 1, __ATOMIC_RELAXED);
+}
+
+/**
+@brief This function drops the oldest slot of a full ring unless the consumer holds it.
+The slot can only be dropped while tail and released are both at it, the compare and swap of tail fails if the consumer claims it first.
+@param ring the full ring
+@return isDropped 1 if the slot was dropped, 0 if the consumer holds it
+**/
+static int dropOldestRingSlot(RingBuffer *ring){
+  size_t oldest = ring->head - ring->numSlots;
+  size_t expected = oldest;
+  if (!__atomic_compare_exchange_n(&ring->tail, &expected, oldest + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+    return 0;
+  }
+  expected = oldest;
+  __atomic_compare_exchange_n(&ring->released, &expected, oldest + 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+  ring->cachedTail = oldest + 1;
+  ring->numDrops++;
+  return 1;
+}
+
+void *reserveRingSlot(RingBuffer *ring){
+  if (ring->head - ring->cachedTail == ring->numSlots) {
+    ring->cachedTail = __atomic_load_n(&ring->released, __ATOMIC_ACQUIRE);
+    if (ring->head - ring->cachedTail == ring->numSlots && !(__atomic_load_n(&ring->dropOldest, __ATOMIC_RELAXED) && dropOldestRingSlot(ring))) {
+      return NULL;
+    }
+  }
+  return ring->slots + (ring->head & ring->mask) * ring->slotBytes;
+}
+
+void publishRingSlot(RingBuffer *ring){
+  __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+  wakeWaitingThread(&ring->consumerWaiting, &ring->headEvent, &ring->wakeTime);
+}
+
+/**
+@brief This function claims the oldest published slot of a ring that drops its oldest slots.
+The slot can no longer be dropped once tail passed it, it stays claimed until releaseRingSlot.
+@param ring the ring
+@return slot the claimed slot, NULL if the ring is empty
+**/
+static void *claimRingSlot(RingBuffer *ring){
+  if (!ring->isClaimed) {
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    do {
+      //a dropped slot may have moved tail past the cached head
+      if (ring->cachedHead - tail - 1 >= ring->numSlots) {
+        ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail == ring->cachedHead) {
+          return NULL;
+        }
+      }
+    } while (!__atomic_compare_exchange_n(&ring->tail, &tail, tail + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    ring->claimed = tail;
+    ring->isClaimed = 1;
+  }
+  return ring->slots + (ring->claimed & ring->mask) * ring->slotBytes;
+}
+
+void *peekRingSlot(RingBuffer *ring){
+  if (ring->dropOldest) {
+    return claimRingSlot(ring);
+  }
+  if (ring->tail == ring->cachedHead) {
+    ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (ring->tail == ring->cachedHead) {
+      return NULL;
+    }
+  }
+  return ring->slots + (ring->tail & ring->mask) * ring->slotBytes;
+}
+
+void releaseRingSlot(RingBuffer *ring){
+  if (ring->dropOldest) {
+    ring->isClaimed = 0;
+    __atomic_store_n(&ring->released, ring->claimed + 1, __ATOMIC_RELEASE);
+  } else {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->released, ring->tail, __ATOMIC_RELEASE);
+  }
+  wakeWaitingThread(&ring->producerWaiting, &ring->tailEvent, NULL);
+}
+
+void *waitFreeRingSlot(RingBuffer *ring){
+  void *slot = reserveRingSlot(ring);
+  if (slot == NULL) {
+    ring->numOverruns++;
+  }
+  while (slot == NULL) {
+    int event = __atomic_load_n(&ring->tailEvent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&ring->producerWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    slot = reserveRingSlot(ring);
+    if (slot == NULL) {
+      futexWait(&ring->tailEvent, event);
+    }
+    __atomic_store_n(&ring->producerWaiting, 0, __ATOMIC_RELAXED);
+  }
+  return slot;
+}
+
+/**
+The wake up latency is measured from the time the producer stamped before its wake up call.
+**/
+void *waitRingSlot(RingBuffer *ring){
+  void *slot = peekRingSlot(ring);
+  while (slot == NULL) {
+    int event = __atomic_load_n(&ring->headEvent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&ring->consumerWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    slot = peekRingSlot(ring);
+    int isClosed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+    if (slot == NULL && !isClosed) {
+      futexWait(&ring->headEvent, event);
+      if (__atomic_load_n(&ring->headEvent, __ATOMIC_ACQUIRE) != event) {
+        ring->numWakeups++;
+        ring->wakeupLatency += (getMonotonicNanoseconds() - __atomic_load_n(&ring->wakeTime, __ATOMIC_RELAXED)) / 1000000.0;
+      }
+    }
+    __atomic_store_n(&ring->consumerWaiting, 0, __ATOMIC_RELAXED);
+    if (slot == NULL && isClosed) {
+      return peekRingSlot(ring);
+    }
+  }
+  return slot;
+}
+
+void closeRingBuffer(RingBuffer *ring){
+  __atomic_store_n(&ring->wakeTime, getMonotonicNanoseconds(), __ATOMIC_RELAXED);
+  __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&ring->headEvent, 1, __ATOMIC_SEQ_CST);
+  futexWake(&ring->headEvent);
+}
+
+void freeRingBuffer(RingBuffer *ring){
+  free(ring->slots);
+  free(ring->data);
+  ring->slots = NULL;
+  ring->data = NULL;
+}
+
+double getRingLag(RingBuffer *ring, double time){
+  return (getMonotonicNanoseconds() - ring->startTime) / 1000000.0 - time;
+}
+
+int initReorderBuffer(ReorderBuffer *buffer, size_t minSlots, size_t slotBytes){
+  memset(buffer, 0, sizeof(ReorderBuffer));
+  buffer->numSlots = 1;
+  while (buffer->numSlots < minSlots) {
+    buffer->numSlots <<= 1;
+  }
+  buffer->mask = buffer->numSlots - 1;
+  buffer->slotStride = (sizeof(size_t) + slotBytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+  void *slots = NULL;
+  if (posix_memalign(&slots, CACHE_LINE_SIZE, buffer->numSlots * buffer->slotStride) != 0) {
+    printf("%s\n", "Reorder buffer could not be allocated!");
+    return 0;
+  }
+  buffer->slots = (char *)slots;
+  memset(buffer->slots, 0, buffer->numSlots * buffer->slotStride);
+  return 1;
+}
+
+int isReorderBufferFull(ReorderBuffer *buffer){
+  if (buffer->head - buffer->cachedTail == buffer->numSlots) {
+    buffer->cachedTail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+  }
+  return buffer->head - buffer->cachedTail == buffer->numSlots;
+}
+
+/**
+The head is only read by the consumer after the buffer is closed, the slots are published by their own sequence numbers.
+**/
+size_t waitReorderSequence(ReorderBuffer *buffer){
+  while (isReorderBufferFull(buffer)) {
+    int event = __atomic_load_n(&buffer->tailEvent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&buffer->producerWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (isReorderBufferFull(buffer)) {
+      futexWait(&buffer->tailEvent, event);
+    }
+    __atomic_store_n(&buffer->producerWaiting, 0, __ATOMIC_RELAXED);
+  }
+  size_t sequence = buffer->head;
+  __atomic_store_n(&buffer->head, sequence + 1, __ATOMIC_RELAXED);
+  return sequence;
+}
+
+void *getReorderSlot(ReorderBuffer *buffer, size_t sequence){
+  return buffer->slots + (sequence & buffer->mask) * buffer->slotStride + sizeof(size_t);
+}
+
+void publishReorderSlot(ReorderBuffer *buffer, size_t sequence){
+  size_t *published = (size_t *)(buffer->slots + (sequence & buffer->mask) * buffer->slotStride);
+  __atomic_store_n(published, sequence + 1, __ATOMIC_RELEASE);
+  wakeWaitingThread(&buffer->consumerWaiting, &buffer->headEvent, &buffer->wakeTime);
+}
+
+void *peekReorderSlot(ReorderBuffer *buffer){
+  size_t *published = (size_t *)(buffer->slots + (buffer->tail & buffer->mask) * buffer->slotStride);
+  if (__atomic_load_n(published, __ATOMIC_ACQUIRE) != buffer->tail + 1) {
+    return NULL;
+  }
+  return getReorderSlot(buffer, buffer->tail);
+}
+
+void *waitReorderSlot(ReorderBuffer *buffer){
+  void *slot = peekReorderSlot(buffer);
+  while (slot == NULL) {
+    int event = __atomic_load_n(&buffer->headEvent, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&buffer->consumerWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    slot = peekReorderSlot(buffer);
+    int isDone = __atomic_load_n(&buffer->closed, __ATOMIC_ACQUIRE) && buffer->tail == __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    if (slot == NULL && !isDone) {
+      futexWait(&buffer->headEvent, event);
+      if (__atomic_load_n(&buffer->headEvent, __ATOMIC_ACQUIRE) != event) {
+        buffer->numWakeups++;
+        buffer->wakeupLatency += (getMonotonicNanoseconds() - __atomic_load_n(&buffer->wakeTime, __ATOMIC_RELAXED)) / 1000000.0;
+      }
+    }
+    __atomic_store_n(&buffer->consumerWaiting, 0, __ATOMIC_RELAXED);
+    if (slot == NULL && isDone) {
+      return NULL;
+    }
+  }
+  return slot;
+}
+
+void releaseReorderSlot(ReorderBuffer *buffer){
+  __atomic_store_n(&buffer->tail, buffer->tail + 1, __ATOMIC_RELEASE);
+  wakeWaitingThread(&buffer->producerWaiting, &buffer->tailEvent, NULL);
+}
+
+void closeReorderBuffer(ReorderBuffer *buffer){
+  __atomic_store_n(&buffer->wakeTime, getMonotonicNanoseconds(), __ATOMIC_RELAXED);
+  __atomic_store_n(&buffer->closed, 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&buffer->headEvent, 1, __ATOMIC_SEQ_CST);
+  futexWake(&buffer->headEvent);
+}
+
+void freeReorderBuffer(ReorderBuffer *buffer){
+  free(buffer->slots);
+  buffer->slots = NULL;
+}
+
+BackpressurePolicy getBackpressurePolicy(char *policyName){
+  if (strcmp(policyName, "drop-oldest") == 0) {
+    return BACKPRESSURE_DROP_OLDEST;
+  } else if (strcmp(policyName, "degrade") == 0) {
+    return BACKPRESSURE_DEGRADE;
+  }
+  return BACKPRESSURE_BLOCK;
+}
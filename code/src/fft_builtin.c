@@ -0,0 +1,89 @@
+/**
+@file fft_builtin.c
+The engine owns its plans instead of taking them from the per thread cache of FFT.c, so it can be
+opened in one thread and closed in another.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the fft engine that runs the transforms of FFT.c.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/fft_builtin.h"
+#include "../include/FFT.h"
+
+struct builtin_fft {
+	struct fft_engine base;
+	FftPlan *plan;
+	sample_t *input;
+	int n;
+};
+
+void close_builtin_fft(struct fft_engine *engine)
+{
+	struct builtin_fft *builtin = (struct builtin_fft *)(engine->data);
+	Fft_destroyPlan(builtin->plan->half);
+	Fft_destroyPlan(builtin->plan);
+	free(builtin->input);
+	free(builtin);
+}
+
+const char *name_builtin_fft(struct fft_engine *engine)
+{
+	(void)engine;
+	return "builtin";
+}
+
+int size_builtin_fft(struct fft_engine *engine)
+{
+	struct builtin_fft *builtin = (struct builtin_fft *)(engine->data);
+	return builtin->n;
+}
+
+sample_t *input_builtin_fft(struct fft_engine *engine)
+{
+	struct builtin_fft *builtin = (struct builtin_fft *)(engine->data);
+	return builtin->input;
+}
+
+int forward_builtin_fft(struct fft_engine *engine, const sample_t *input, sample_t *outReal, sample_t *outImag)
+{
+	struct builtin_fft *builtin = (struct builtin_fft *)(engine->data);
+	return Fft_transformReal(builtin->plan, input, outReal, outImag);
+}
+
+int open_builtin_fft(struct fft_engine **p, int size)
+{
+	if (size < 2) {
+		fprintf(stderr, "fft size %d not supported!\n", size);
+		return 0;
+	}
+	struct builtin_fft *builtin = (struct builtin_fft *)malloc(sizeof(struct builtin_fft));
+	builtin->base.close = close_builtin_fft;
+	builtin->base.name = name_builtin_fft;
+	builtin->base.size = size_builtin_fft;
+	builtin->base.forward = forward_builtin_fft;
+	builtin->base.input = input_builtin_fft;
+	builtin->base.data = (void *)builtin;
+	builtin->n = size;
+	builtin->input = (sample_t *)calloc(size, sizeof(sample_t));
+	builtin->plan = Fft_createPlan(size);
+	if (builtin->plan == NULL || builtin->input == NULL) {
+		fprintf(stderr, "couldnt create fft plan of size %d!\n", size);
+		Fft_destroyPlan(builtin->plan);
+		free(builtin->input);
+		free(builtin);
+		return 0;
+	}
+	// Odd sizes are transformed without the plan of half the size
+	if (size % 2 == 0)
+		builtin->plan->half = Fft_createPlan(size / 2);
+	if (size % 2 == 0 && builtin->plan->half == NULL) {
+		fprintf(stderr, "couldnt create fft plan of size %d!\n", size / 2);
+		Fft_destroyPlan(builtin->plan);
+		free(builtin->input);
+		free(builtin);
+		return 0;
+	}
+	*p = &(builtin->base);
+	return 1;
+}
@@ -0,0 +1,46 @@
+/**
+@file fft_engine.c
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the dispatching of the exchangeable fft engines.
+**/
+#include <stdio.h>
+#include <string.h>
+#include "../include/fft_engine.h"
+#include "../include/fft_builtin.h"
+#include "../include/fft_fftw.h"
+
+void close_fft_engine(struct fft_engine *engine)
+{
+	engine->close(engine);
+}
+
+const char *name_fft_engine(struct fft_engine *engine)
+{
+	return engine->name(engine);
+}
+
+int size_fft_engine(struct fft_engine *engine)
+{
+	return engine->size(engine);
+}
+
+sample_t *input_fft_engine(struct fft_engine *engine)
+{
+	return engine->input(engine);
+}
+
+int forward_fft_engine(struct fft_engine *engine, const sample_t *input, sample_t *outReal, sample_t *outImag)
+{
+	return engine->forward(engine, input, outReal, outImag);
+}
+
+int open_fft_engine(struct fft_engine **p, const char *name, int size)
+{
+	if (strcmp(name, "builtin") == 0)
+		return open_builtin_fft(p, size);
+	if (strcmp(name, "fftw") == 0)
+		return open_fftw_fft(p, size);
+	fprintf(stderr, "unknown fft engine %s!\n", name);
+	return 0;
+}
@@ -0,0 +1,136 @@
+/**
+@file fft_fftw.c
+The planner of FFTW measures several algorithms for a size before it decides on one, which takes
+seconds on the Raspberry Pi for the larger sizes. The decisions (wisdom) are therefore loaded from
+FFTW_WISDOM_FILE before the first plan is created and written back whenever a size had to be measured.
+The planner of FFTW is not thread safe, so planning is serialized with a mutex. Executing a plan is thread safe.
+Only the single precision library is linked, a double precision build converts the frames to float and back.
+In a single precision build the input buffer of the engine is the input array of the plan, frames staged into it are not copied.
+@author Lukas Graber
+@date 30 May 2019
+@brief Implementation of the fft engine that runs the transforms with FFTW3 in single precision.
+**/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <fftw3.h>
+#include "../include/fft_fftw.h"
+#include "../include/ApplicationMacros.h"
+
+static pthread_mutex_t plannerMutex = PTHREAD_MUTEX_INITIALIZER;
+static int isWisdomLoaded = 0;
+
+struct fftw_fft {
+	struct fft_engine base;
+	fftwf_plan plan;
+	float *in;
+	fftwf_complex *out;
+	sample_t *input;
+	int n;
+};
+
+void close_fftw_fft(struct fft_engine *engine)
+{
+	struct fftw_fft *fftw = (struct fftw_fft *)(engine->data);
+	pthread_mutex_lock(&plannerMutex);
+	fftwf_destroy_plan(fftw->plan);
+	pthread_mutex_unlock(&plannerMutex);
+	fftwf_free(fftw->in);
+	fftwf_free(fftw->out);
+#ifndef SINGLE_PRECISION
+	free(fftw->input);
+#endif
+	free(fftw);
+}
+
+const char *name_fftw_fft(struct fft_engine *engine)
+{
+	(void)engine;
+	return "fftw";
+}
+
+int size_fftw_fft(struct fft_engine *engine)
+{
+	struct fftw_fft *fftw = (struct fftw_fft *)(engine->data);
+	return fftw->n;
+}
+
+sample_t *input_fftw_fft(struct fft_engine *engine)
+{
+	struct fftw_fft *fftw = (struct fftw_fft *)(engine->data);
+	return fftw->input;
+}
+
+int forward_fftw_fft(struct fft_engine *engine, const sample_t *input, sample_t *outReal, sample_t *outImag)
+{
+	struct fftw_fft *fftw = (struct fftw_fft *)(engine->data);
+	if ((const void *)input != (const void *)fftw->in) {
+		for (int i = 0; i < fftw->n; i++)
+			fftw->in[i] = input[i];
+	}
+	fftwf_execute(fftw->plan);
+	for (int i = 0; i <= fftw->n / 2; i++) {
+		outReal[i] = fftw->out[i][0];
+		outImag[i] = fftw->out[i][1];
+	}
+	return 1;
+}
+
+int open_fftw_fft(struct fft_engine **p, int size)
+{
+	if (size < 2) {
+		fprintf(stderr, "fft size %d not supported!\n", size);
+		return 0;
+	}
+	struct fftw_fft *fftw = (struct fftw_fft *)malloc(sizeof(struct fftw_fft));
+	fftw->base.close = close_fftw_fft;
+	fftw->base.name = name_fftw_fft;
+	fftw->base.size = size_fftw_fft;
+	fftw->base.forward = forward_fftw_fft;
+	fftw->base.input = input_fftw_fft;
+	fftw->base.data = (void *)fftw;
+	fftw->n = size;
+	fftw->in = fftwf_alloc_real(size);
+	fftw->out = fftwf_alloc_complex(size / 2 + 1);
+#ifdef SINGLE_PRECISION
+	fftw->input = fftw->in;
+#else
+	fftw->input = (sample_t *)calloc(size, sizeof(sample_t));
+#endif
+	if (fftw->in == NULL || fftw->out == NULL || fftw->input == NULL) {
+		fprintf(stderr, "couldnt allocate fftw buffers of size %d!\n", size);
+		fftwf_free(fftw->in);
+		fftwf_free(fftw->out);
+#ifndef SINGLE_PRECISION
+		free(fftw->input);
+#endif
+		free(fftw);
+		return 0;
+	}
+
+	pthread_mutex_lock(&plannerMutex);
+	if (!isWisdomLoaded) {
+		fftwf_import_wisdom_from_filename(FFTW_WISDOM_FILE);
+		isWisdomLoaded = 1;
+	}
+	// Planning with FFTW_MEASURE overwrites the buffers, they are filled for every frame anyway
+	fftw->plan = fftwf_plan_dft_r2c_1d(size, fftw->in, fftw->out, FFTW_MEASURE | FFTW_WISDOM_ONLY);
+	if (fftw->plan == NULL) {
+		fftw->plan = fftwf_plan_dft_r2c_1d(size, fftw->in, fftw->out, FFTW_MEASURE);
+		if (fftw->plan != NULL && !fftwf_export_wisdom_to_filename(FFTW_WISDOM_FILE))
+			fprintf(stderr, "couldnt write fftw wisdom to %s!\n", FFTW_WISDOM_FILE);
+	}
+	pthread_mutex_unlock(&plannerMutex);
+	if (fftw->plan == NULL) {
+		fprintf(stderr, "couldnt create fftw plan of size %d!\n", size);
+		fftwf_free(fftw->in);
+		fftwf_free(fftw->out);
+#ifndef SINGLE_PRECISION
+		free(fftw->input);
+#endif
+		free(fftw);
+		return 0;
+	}
+	*p = &(fftw->base);
+	return 1;
+}
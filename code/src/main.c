@@ -14,6 +14,10 @@
 #include <time.h>
 #include <dirent.h>
 #include <assert.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
 
 #include "../include/Structures.h"
 #include "../include/pcm.h"
@@ -23,10 +27,16 @@
 #include "../include/AudioTranscription.h"
 #include "../include/AudioPreProcessing.h"
 #include "../include/FFT.h"
+#include "../include/fft_engine.h"
+#include "../include/NoteBank.h"
+#include "../include/NoteTracker.h"
+#include "../include/RingBuffer.h"
+#include "../include/FrameAnalysisPool.h"
 
 SongConfiguration songConfiguration;
 RunTimeInformation runTimeInformation;
-AudioDataQueue audioDataQueue;
+RingBuffer audioRingBuffer;
+FrameAnalysisPool frameAnalysisPool;
 
 struct timespec start_timer, current_timer;
 
@@ -37,6 +47,17 @@ double fftRunTime;
 double audioPreProcessingTime;
 double audioTranscriptionTime;
 double audioCaptureTime;
+double spectralStageTime;
+double analysisStageTime;
+double trackingStageTime;
+int analysisWorkers;
+int wakeups;
+double wakeupLatency;
+int overruns;
+int droppedFrames;
+int droppedPeriods;
+double meanLag;
+double maxLag;
 
 static int numBins = 1;
 //static char* PATH = "../output/";
@@ -59,16 +80,24 @@ static int __isRecording = 0;
 //static int __isMidiFilePlaying = 0;
 //static int __isCapturingAudio = 0;
 static int __isAudioProcessing = 0;
+static int __isFrameAnalysisReady = 0;
 int retError = 0;
 
-//pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER; /*!< mutex to manage access no queue where data is shared between threads.**/
-pthread_mutex_t mutex;
-
 void fail(){
   printf("%s\n", "Something went wrong!");
   exit(0);
 }
 
+/**
+@brief This function returns the time between two time stamps in milliseconds.
+@param start the earlier time stamp
+@param end the later time stamp
+@return elapsedTime the difference in milliseconds
+**/
+double getElapsedMilliseconds(struct timespec *start, struct timespec *end){
+  return (end->tv_sec - start->tv_sec)*1000.0 + (end->tv_nsec - start->tv_nsec)/1000000.0;
+}
+
 /**
 @brief This function compares measured melody with test melody.
 At first, the function will translate the lilypond string into frequencies and note durations stored in arrays. This is done, such that
@@ -356,6 +385,31 @@ void GenerateNoteSheet(char *musicalExpression){
   }
 }
 
+/**
+@brief This function stores and prints a note that the note tracker of a frame loop has finished.
+The lilypond text of the note is only rendered here, the frame loops compare midi note numbers. Rests are not stored.
+@param event the finished note or rest
+@param capturedDataPoints the notes of the frame loop
+@param decibel the loudness of the note
+**/
+void insertNoteEvent(NoteEvent *event, CapturedDataPoints *capturedDataPoints, double decibel){
+  if (event->midiNote == NO_MIDI_NOTE) {
+    return;
+  }
+  char *musicalNote = getLilyPondNote(event->midiNote);
+  char *currentExpression = calculateNoteLength(musicalNote,event->duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
+  if (strlen(currentExpression)>0) {
+    MusicalDataPoint dP;
+    initMusicalDataPoint(&dP, event->frequency, event->duration, decibel);
+    insertMusicalDataPoint(capturedDataPoints, dP);
+    if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
+      printf("Current Time: %f - %f (%s) - Duration:%f\n",event->onsetTime + event->duration, event->frequency, currentExpression, event->duration);
+    }
+  }
+  free(musicalNote);
+  free(currentExpression);
+}
+
 /**
 @brief This function implements a metronome.
 The function receives the location of the WAV file as an argument. While the audio capture is still recording data, play the metronome tick.
@@ -371,7 +425,7 @@ void *metronome_entry_point(void *arg){
         char command[1024];
         sprintf(command,"play -q %s",beatAudioFile);
         //while(__isRecording){
-        while(runTimeInformation.isCapturingAudio){
+        while(getFlag(&runTimeInformation.isCapturingAudio)){
             retError = system(command);
             if (retError == -1) {
               fail();
@@ -388,10 +442,9 @@ void *metronome_entry_point(void *arg){
 @brief This function is the entry point for the audio capturing/recording thread.
 A thread will be created by calling this function as the entry point of the corresponding
 thread. It will collect audio samples from the audio interface as long as the recording
-time is not up. The collected samples will be put in a queue that is shared data structure with
-the audio processing thread. Before writing to the queue, the thread needs to contact
-the mutex to block other threads from accessing the queue. As soon as the writing operation
-is done, the thread needs to unlock the queue by contacting the mutex again.
+time is not up. The samples are read directly into the free slots of the ring that is shared with
+the spectral analysis thread, every period is published without a lock or an allocation. When the
+recording time is up, the ring is closed to end the following threads of the pipeline.
 **/
 void *audio_capture_entry_point(void *arg){
   struct pcm *pcm;
@@ -407,7 +460,10 @@ void *audio_capture_entry_point(void *arg){
   __rate = rate;
   __channels = channels;
 
-  short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
+  size_t minSlots = (size_t)ceil(AUDIO_RING_BUFFER_TIME / 1000.0 * rate / runTimeInformation.stepSize);
+  if (!initAudioRingBuffer(&audioRingBuffer, minSlots, channels * runTimeInformation.stepSize)) {
+    fail();
+  }
 
   pthread_t metronomeThread;
   if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
@@ -429,68 +485,119 @@ void *audio_capture_entry_point(void *arg){
   }
   pthread_create(&metronomeThread,NULL,metronome_entry_point,BEAT_AUDIO_FILE);
 
-  __isAudioInterfaceReady = 1;
-
-  runTimeInformation.isCapturingAudio = 1;
+  setFlag(&runTimeInformation.isCapturingAudio, 1);
+  setFlag(&__isAudioInterfaceReady, 1);
 
   if (runTimeInformation.melodyBenchmarking) {
-    while (!runTimeInformation.isMidiFilePlaying) {
-      msleep(5);
-    }
+    waitFlag(&runTimeInformation.isMidiFilePlaying, TRUE);
   }
 
   struct timespec start_t, current_t;
 	clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
 	clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+  audioRingBuffer.startTime = start_t.tv_sec * 1000000000LL + start_t.tv_nsec;
 
   double currentTime = (current_t.tv_sec - start_t.tv_sec)*1000.0+ (current_t.tv_nsec - start_t.tv_nsec)/1000000.0;
   __isRecording = (currentTime < runTimeInformation.recordingTime*1000);
   while (__isRecording) {
+    AudioCapturePoint *dataPoint = (AudioCapturePoint *)waitFreeRingSlot(&audioRingBuffer);
     clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_capture_t);
-    if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
-      memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
+    if (!read_pcm(pcm, dataPoint->arr, runTimeInformation.stepSize))
+      memset(dataPoint->arr, 0, sizeof(short) * channels * runTimeInformation.stepSize);
     clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
     audioCaptureTime += (current_time_t.tv_sec - start_audio_capture_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_capture_t.tv_nsec)/1000000.0;
 
-    AudioCapturePoint *dataPoint = initAudioCapturePoint(channels * runTimeInformation.stepSize);
-    dataPoint->captureTime = (current_t.tv_sec - start_t.tv_sec)*1000.0+ (current_t.tv_nsec - start_t.tv_nsec)/1000000.0;
-    for(int i = 0; i < channels * runTimeInformation.stepSize;i++){
-      insertAudioCapturePoint(dataPoint, buff[i]);
-    }
-    pthread_mutex_lock(&mutex);
-    //queue_enqueue(&audioDataQueue, &dataPoint);
-    queue_enqueue(&audioDataQueue, dataPoint);
-    pthread_mutex_unlock(&mutex);
+    dataPoint->captureTime = (current_time_t.tv_sec - start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_t.tv_nsec)/1000000.0;
+    publishRingSlot(&audioRingBuffer);
     clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
     double currentTime = (current_t.tv_sec - start_t.tv_sec)*1000.0 + (current_t.tv_nsec - start_t.tv_nsec)/1000000.0;
     __isRecording = (currentTime < runTimeInformation.recordingTime*1000);
   }
-  runTimeInformation.isCapturingAudio = 0;
+  closeRingBuffer(&audioRingBuffer);
+  setFlag(&runTimeInformation.isCapturingAudio, 0);
   pthread_join(metronomeThread,NULL);
-  __isAudioInterfaceReady = 0;
-  while (__isAudioProcessing) {
-    msleep(10);
-  }
-  free(buff);
+  setFlag(&__isAudioInterfaceReady, 0);
+  waitFlag(&__isAudioProcessing, 0);
   close_pcm(pcm);
   return NULL;
 }
 
 /**
-@brief This function is the entry point for the audio processing thread.
+@brief This function looks up the note of a spectral frame and feeds it to the note tracker of a melody mode.
+A skipped frame holds the note and the frequency of the last analyzed frame.
+@param spectralFrame the spectral frame of the next hop
+@param noteTable the note table of the frame loop
+@param noteTracker the note tracker of the frame loop
+@param currentNote the note of the last analyzed frame, is updated
+@param frequency the frequency of the last analyzed frame, is updated
+@param capturedDataPoints receives the ended notes
+**/
+void trackSpectralFrame(const SpectralFrame *spectralFrame, const NoteTable *noteTable, NoteTracker *noteTracker, int *currentNote, double *frequency, CapturedDataPoints *capturedDataPoints){
+  NoteEvent noteEvent;
+  float decibel = -60.0;
+  if (!spectralFrame->isSkipped) {
+    *frequency = spectralFrame->frequency;
+    *currentNote = spectralFrame->isFractional ? getNoteOfBinPosition(noteTable,spectralFrame->position,NULL) : getNoteOfBin(noteTable,spectralFrame->frequencyBin,NULL);
+  }
+  if (updateNoteTracker(noteTracker, *currentNote, *frequency, spectralFrame->captureTime, &noteEvent)) {
+    insertNoteEvent(&noteEvent, capturedDataPoints, decibel);
+  }
+}
+
+/**
+@brief This function is the entry point for the spectral analysis thread, the second stage of the threaded pipeline.
 A thread will be created by calling this function as the entry point of the corresponding
-thread. It will collect the save samples from the queue and process them.
-The collected samples will be be read from the queue that is shared data structure with
-the audio capturing thread. Before reading from the queue, the thread needs to contact
-the mutex to block other threads from accessing the queue. As soon as the reading operation
-is done, the thread needs to unlock the queue by contacting the mutex again.
+thread. It will stage the samples of the ring that is shared with the audio capturing thread in the order they were captured
+and submit every frame to the frame analysis pool, whose threads analyze the overlapping frames in parallel and hand the peaks of
+the spectra to the note tracking thread in the order of the hops. A slot is returned to the capture thread as soon as its samples are
+staged for the frame. The thread sleeps while the ring is empty and closes the pool when the ring is closed and read.
+With the drop-oldest policy the capture thread overwrites the oldest period of the ring that was not read yet instead of waiting for a free
+slot. With the degrade policy every second hop that waited longer than AUDIO_LAG_DEADLINE hops for its processing is staged but not
+analyzed, the note tracking thread holds the note of the last analyzed hop for it. The sliding dft and the constant q analyzers carry their
+state from hop to hop, they need every hop and always block the capture thread while the ring is full.
 **/
-void *audio_processing_entry_point(){
-  int isQueueEmpty = FALSE;
+void *spectral_analysis_entry_point(){
+  waitFlag(&__isAudioInterfaceReady, 1);
+  float rate = __rate;
 
-  while(!__isAudioInterfaceReady){
-    msleep(10);
+  int firstCore = runTimeInformation.pinPipelineThreads ? 3 : -1;
+  if (!initFrameAnalysisPool(&frameAnalysisPool, &runTimeInformation, rate, runTimeInformation.frameAnalysisWorkers, firstCore)) {
+    fail();
+  }
+  setFlag(&__isFrameAnalysisReady, 1);
+
+  BackpressurePolicy backpressurePolicy = getBackpressurePolicy(runTimeInformation.backpressurePolicy);
+  int canSkipHops = !frameAnalysisPool.useConstantQ && (!frameAnalysisPool.useNoteBank || frameAnalysisPool.workers[0].noteBank.analyzer != NOTE_BANK_SLIDING_DFT);
+  double lagDeadline = AUDIO_LAG_DEADLINE * 1000.0 * runTimeInformation.stepSize / rate;
+  int numLateHops = 0;
+  droppedFrames = 0;
+  if (backpressurePolicy == BACKPRESSURE_DROP_OLDEST && canSkipHops) {
+    setRingDropOldest(&audioRingBuffer);
   }
+
+  AudioCapturePoint *dataPoint;
+  while((dataPoint = (AudioCapturePoint *)waitRingSlot(&audioRingBuffer)) != NULL){
+    int isLate = backpressurePolicy == BACKPRESSURE_DEGRADE && canSkipHops && getRingLag(&audioRingBuffer, dataPoint->captureTime) > lagDeadline;
+    numLateHops = isLate ? numLateHops + 1 : 0;
+    int skipHop = numLateHops % 2 == 1;
+    submitFrame(&frameAnalysisPool, dataPoint->arr, dataPoint->captureTime, skipHop);
+    releaseRingSlot(&audioRingBuffer);
+    droppedFrames += skipHop;
+  }
+  closeFrameAnalysisPool(&frameAnalysisPool);
+  return NULL;
+}
+
+/**
+@brief This function is the entry point for the note tracking thread, the last stage of the threaded pipeline.
+A thread will be created by calling this function as the entry point of the corresponding
+thread. It will look up the note of every spectral frame of the frame analysis pool, in the order the hops were captured, and feed
+it to the note tracker. The lag of a hop is measured once it is tracked, such that it covers the whole pipeline from the end of its capture.
+The thread sleeps while the next spectral frame is not analyzed and writes the notesheet when the pool is closed and read.
+**/
+void *note_tracking_entry_point(){
+  setFlag(&__isAudioProcessing, 1);
+  waitFlag(&__isAudioInterfaceReady, 1);
   float rate = __rate;
   int channels = __channels;
 
@@ -499,119 +606,42 @@ void *audio_processing_entry_point(){
 
   CapturedDataPoints capturedDataPoints;
   initCapturedDataPoints(&capturedDataPoints);
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
 
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-
-  //char *musicalExpression = "";
   double currentTime = 0;
-  double lastTime = currentTime;
-	char *lastNote = "";
-  char *currentNote = "";
-	double duration = 0;
+  NoteTracker noteTracker;
+  initNoteTracker(&noteTracker, 1000.0 * runTimeInformation.stepSize / rate);
+  NoteEvent noteEvent;
   float decibel = -60.0;
-  int oldBin = 0;
-
-  __isAudioProcessing = 1;
-  while(__isRecording || !isQueueEmpty){
-    pthread_mutex_lock(&mutex);
-    isQueueEmpty = queue_empty(&audioDataQueue);
-    pthread_mutex_unlock(&mutex);
-    if (!isQueueEmpty) {
-      clock_gettime(CLOCK_MONOTONIC_RAW,&single_run_start_t);
-      AudioCapturePoint dataPoint;
-      //initAudioCapturePoint(&dataPoint, runTimeInformation.stepSize);
-      pthread_mutex_lock(&mutex);
-      dataPoint = *queue_dequeue(&audioDataQueue);
-      pthread_mutex_unlock(&mutex);
-      currentTime = dataPoint.captureTime;
-      shiftWrite(inputReal, dataPoint.arr, runTimeInformation.sampleSize, runTimeInformation.stepSize);
-
-      //Audio Preprocessing
-      clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_preprocessing_t);
-      double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-      double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-
-      applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-
-      clock_gettime(CLOCK_MONOTONIC_RAW,&fft_run_start_t);
-      Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-      fftRunTime += (current_time_t.tv_sec - fft_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - fft_run_start_t.tv_nsec)/1000000.0;
-
-      getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-      applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
-
-      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-      audioPreProcessingTime += (current_time_t.tv_sec - start_audio_preprocessing_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_preprocessing_t.tv_nsec)/1000000.0;
-
-      //Audio Transcription
-      clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_transcription_t);
-      int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
-      //double amplitude = amps[frequencyBin];
-      double frequency = (double)frequencyBin * rate/runTimeInformation.sampleSize;
-      currentNote = getMusicalNote(frequency,runTimeInformation.tuningPitch,runTimeInformation.pitchResolutionInCents);
-
-      duration = currentTime - lastTime;
-      if(duration > (60.0*1000)/(runTimeInformation.beatsPerMinute*(RHYTHM_RESOLUTION/RHYTHM_DENOMINATOR))/2.0 && strcmp(currentNote, lastNote)!=0 && strcmp(currentNote, "") != 0){
-        double freq = oldBin * rate/runTimeInformation.sampleSize;
-        char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-        char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-        if (strlen(currentExpression)>0) {
-          MusicalDataPoint dP;
-          initMusicalDataPoint(&dP, freq, duration, decibel);
-          insertMusicalDataPoint(&capturedDataPoints, dP);
-          //musicalExpression = append(musicalExpression, currentExpression);
-          //musicalExpression = append(musicalExpression, " ");
-          if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-            printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-          }
-          lastTime = currentTime;
-          lastNote = currentNote;
-        }
-        //decibel = 10.0f * log10f(fmaxf(0.000001f, out[oldBins[0]] * out[oldBins[0]]));
-        //lastTime = currentTime;
-        oldBin = frequencyBin;
-        duration = 0;
-        free(musicalNote);
-        free(currentExpression);
-      }
-      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-      audioTranscriptionTime += (current_time_t.tv_sec - start_audio_transcription_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_transcription_t.tv_nsec)/1000000.0;
-      free(actualoutreal);
-      free(actualoutimag);
-
-      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-      runTime += (current_time_t.tv_sec - single_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - single_run_start_t.tv_nsec)/1000000.0;
-
-      runs++;
-    }
-    pthread_mutex_lock(&mutex);
-    isQueueEmpty = queue_empty(&audioDataQueue);
-    pthread_mutex_unlock(&mutex);
+  int currentNote = NO_MIDI_NOTE;
+  double frequency = 0;
+
+  int numHops = 0;
+  double lagSum = 0;
+  maxLag = 0;
+
+  waitFlag(&__isFrameAnalysisReady, 1);
+  struct timespec stage_start_t, stage_current_t;
+  const SpectralFrame *spectralFrame;
+  while((spectralFrame = waitSpectralFrame(&frameAnalysisPool)) != NULL){
+    clock_gettime(CLOCK_MONOTONIC_RAW,&stage_start_t);
+    currentTime = spectralFrame->captureTime;
+    trackSpectralFrame(spectralFrame, noteTable, &noteTracker, &currentNote, &frequency, &capturedDataPoints);
+    double lag = getRingLag(&audioRingBuffer, spectralFrame->captureTime);
+    releaseSpectralFrame(&frameAnalysisPool);
+    clock_gettime(CLOCK_MONOTONIC_RAW,&stage_current_t);
+    double stageTime = getElapsedMilliseconds(&stage_start_t, &stage_current_t);
+    trackingStageTime += stageTime;
+    audioTranscriptionTime += stageTime;
+    lagSum += lag;
+    maxLag = fmax(maxLag, lag);
+    numHops++;
+    runs++;
   }
-  if(duration > 0){
-    double freq = oldBin * rate/runTimeInformation.sampleSize;
-    char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-    char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-    MusicalDataPoint dP;
-    initMusicalDataPoint(&dP, freq, duration, decibel);
-    insertMusicalDataPoint(&capturedDataPoints, dP);
-    //musicalExpression = append(musicalExpression, currentExpression);
-    //musicalExpression = append(musicalExpression, " ");
-    if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-      printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-    }
-    lastNote = currentNote;
-    oldBin = 0;
-    duration = 0;
-    free(musicalNote);
-    free(currentExpression);
+  meanLag = numHops > 0 ? lagSum / numHops : 0;
+  if (finishNoteTracker(&noteTracker, currentTime, &noteEvent)) {
+    insertNoteEvent(&noteEvent, &capturedDataPoints, decibel);
   }
-  clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
   if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
     char *musicalExpression = (char *)calloc(32, sizeof(char));
     strcpy(musicalExpression, "");
@@ -630,26 +660,25 @@ void *audio_processing_entry_point(){
     compareCapturedDataToOriginal(benchmarkingMelody, benchmarkingMode, benchmarkingFileName, &capturedDataPoints);
   }
   freeCapturedDataPoints(&capturedDataPoints);
-  free(inputReal);
-  free(inputImag);
-  free(amps);
-  __isAudioProcessing = 0;
+  setFlag(&__isAudioProcessing, 0);
   runTimeInformation.quit = 0;
   return NULL;
 }
 
 /**
 @brief This function implements the parallel implementation of the Music Transcription Pipeline.
-The function creates two threads that will be running in parallel. One of the threads is capturing
-audio, the other one is processing the audio samples and transcribes it to a melody. Both threads use
-a queue as shared data structure as well as a mutex to keep being synchronized and for the queue
-not becoming inconsistent.
+The function creates three threads that will be running in parallel as the stages of a pipeline. The first thread is capturing
+audio, the second one stages the audio samples into overlapping frames for the threads of a frame analysis pool, which analyze the
+frames in parallel, and the third one transcribes the peaks of the spectra to a melody in the order of the hops. The capture and the
+staging thread share a lock-free single producer single consumer ring of preallocated slots, the spectral frames are put back in
+order by the reorder buffer of the pool. The threads are pinned to their own cores if configured, such that with small hops the
+throughput is bound by the slowest stage instead of the sum of all stages.
 @param pcmDeviceName the sound card name
 **/
 void threadedRealTimeVersion(char *pcmDeviceName){
   pthread_t audioCaptureThread;
-  pthread_t audioProcessingThread;
-  pthread_mutex_init(&mutex, NULL);
+  pthread_t spectralAnalysisThread;
+  pthread_t noteTrackingThread;
 
   runs = 0;
   fftRunTime = 0;
@@ -657,16 +686,36 @@ void threadedRealTimeVersion(char *pcmDeviceName){
   audioCaptureTime = 0;
   audioPreProcessingTime = 0;
   audioTranscriptionTime = 0;
-
-  initAudioDataQueue(&audioDataQueue);
+  spectralStageTime = 0;
+  analysisStageTime = 0;
+  trackingStageTime = 0;
+  setFlag(&__isFrameAnalysisReady, 0);
 
   pthread_create(&audioCaptureThread,NULL,audio_capture_entry_point,pcmDeviceName);
-  pthread_create(&audioProcessingThread,NULL,audio_processing_entry_point,NULL);
+  pthread_create(&spectralAnalysisThread,NULL,spectral_analysis_entry_point,NULL);
+  pthread_create(&noteTrackingThread,NULL,note_tracking_entry_point,NULL);
+  if (runTimeInformation.pinPipelineThreads) {
+    pinThreadToCore(audioCaptureThread, 0);
+    pinThreadToCore(spectralAnalysisThread, 1);
+    pinThreadToCore(noteTrackingThread, 2);
+  }
 
   pthread_join(audioCaptureThread,NULL);
-  pthread_join(audioProcessingThread,NULL);
-  pthread_mutex_destroy(&mutex);
-  freeAudioDataQueue(&audioDataQueue);
+  pthread_join(spectralAnalysisThread,NULL);
+  pthread_join(noteTrackingThread,NULL);
+  double analysisTime;
+  getFrameAnalysisTimes(&frameAnalysisPool, &analysisStageTime, &analysisTime, &fftRunTime);
+  spectralStageTime = frameAnalysisPool.stagingTime;
+  analysisWorkers = frameAnalysisPool.numWorkers;
+  audioPreProcessingTime = spectralStageTime + analysisTime;
+  runTime = audioPreProcessingTime + trackingStageTime;
+  wakeups = audioRingBuffer.numWakeups + frameAnalysisPool.results.numWakeups;
+  wakeupLatency = audioRingBuffer.wakeupLatency + frameAnalysisPool.results.wakeupLatency;
+  overruns = audioRingBuffer.numOverruns + audioRingBuffer.numDrops;
+  droppedPeriods = audioRingBuffer.numDrops;
+  droppedFrames += droppedPeriods;
+  freeRingBuffer(&audioRingBuffer);
+  freeFrameAnalysisPool(&frameAnalysisPool);
 }
 
 /**
@@ -711,48 +760,77 @@ void chordDetector(char *soundCardName){
   __isRecording = 1;
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int numFrequencyBins = runTimeInformation.sampleSize/2 + 1;
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, runTimeInformation.sampleSize, runTimeInformation.stepSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  struct fft_engine *fftEngine;
+  if (!open_fft_engine(&fftEngine, runTimeInformation.fftEngine, runTimeInformation.sampleSize)) {
+    fail();
+  }
+  sample_t *frame = input_fft_engine(fftEngine);
+  int minBin, maxBin;
+  getBandpassBins(&minBin, &maxBin, runTimeInformation.sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
+  NoteBank noteBank;
+  ConstantQTransform constantQ;
+  int useConstantQ = strcmp(runTimeInformation.spectralAnalyzer, "constant-q") == 0;
+  int useNoteBank = !useConstantQ && strcmp(runTimeInformation.spectralAnalyzer, "fft") != 0;
+  if (useNoteBank && !initNoteBank(&noteBank, runTimeInformation.spectralAnalyzer, runTimeInformation.sampleSize, runTimeInformation.stepSize, rate, runTimeInformation.tuningPitch, runTimeInformation.noteBankNeighbours, runTimeInformation.windowingFunction, runTimeInformation.kaiserBeta)) {
+    fail();
+  }
+  if (useConstantQ && !initConstantQTransform(&constantQ, runTimeInformation.fftEngine, runTimeInformation.sampleSize, runTimeInformation.stepSize, rate, runTimeInformation.tuningPitch, runTimeInformation.constantQBinsPerOctave)) {
+    fail();
+  }
 
   runTimeInformation.quit = 0;
   while(!runTimeInformation.quit){
       if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
         memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-      shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
-
-      double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-      double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-      applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-      Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-
-      //audio preprocessing
-      getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-      applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+      const sample_t *inputReal = stageFrame(&frameStager, buff, useNoteBank || useConstantQ ? NULL : frame);
+
+      if (useNoteBank) {
+        analyzeNoteBank(&noteBank,inputReal,amps);
+        applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+      } else if (useConstantQ) {
+        analyzeConstantQ(&constantQ,inputReal,amps);
+        applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+      } else {
+        forward_fft_engine(fftEngine,frame,outReal,outImag);
+
+        //audio preprocessing
+        getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
+      }
 
       //audio processing
-      getBins(bins,numBins,amps,runTimeInformation.sampleSize,rate,runTimeInformation.tuningPitch);
+      int numFound = getPeakBins(bins,numBins,amps,noteTable);
       //int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
 
-      for (int i = 0; i < numBins; i++) {
+      for (int i = 0; i < numFound; i++) {
         //double amplitude = amps[bins[i]];
-        double frequency = (double)bins[i] * rate/runTimeInformation.sampleSize;
+        double frequency = useConstantQ ? getConstantQFrequency(&constantQ,bins[i]) : (double)bins[i] * rate/runTimeInformation.sampleSize;
         char* currentNote = getMusicalNote(frequency,runTimeInformation.tuningPitch,runTimeInformation.pitchResolutionInCents);
         printf("%d. %f Hz (%s) - ",i+1,frequency,currentNote);
+        free(currentNote);
       }
       printf("%s\n", "");
-
-      free(actualoutreal);
-      free(actualoutimag);
-      for (int i = 0; i < numBins; i++) {
-        bins[i] = 0;
-      }
       __isRecording = runTimeInformation.quit;
   }
+  free(bins);
   free(buff);
-  free(inputReal);
-  free(inputImag);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
   free(amps);
+  if (useNoteBank) {
+    freeNoteBank(&noteBank);
+  }
+  if (useConstantQ) {
+    freeConstantQTransform(&constantQ);
+  }
+  close_fft_engine(fftEngine);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -762,7 +840,7 @@ void chordDetector(char *soundCardName){
 The function puts all the audio data at a specific time point in a csv file. This
 data will later be used by a python script to be visualized.
 **/
-void insertIntoCSVFile(char *csvFileName, double *out, int sampleSize, double currentTime){
+void insertIntoCSVFile(char *csvFileName, sample_t *out, int sampleSize, double currentTime){
   int arraySize = (int) sampleSize/2;
   FILE *fp;
   //fp=fopen(csvFileName,"a+");
@@ -851,9 +929,17 @@ void buildAudioSpectrogram(char *wavFileName, char *csvFileName){
   int channels = channels_pcm(pcm);
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int numFrequencyBins = runTimeInformation.sampleSize/2 + 1;
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, runTimeInformation.sampleSize, runTimeInformation.stepSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  struct fft_engine *fftEngine;
+  if (!open_fft_engine(&fftEngine, runTimeInformation.fftEngine, runTimeInformation.sampleSize)) {
+    fail();
+  }
+  sample_t *frame = input_fft_engine(fftEngine);
 
   double currentTime = 0;
   runTimeInformation.quit = !(currentTime < runTimeInformation.recordingTime);
@@ -861,21 +947,17 @@ void buildAudioSpectrogram(char *wavFileName, char *csvFileName){
   while(!runTimeInformation.quit) {
     if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
       memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-    shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
+    stageFrame(&frameStager, buff, frame);
     currentTime += (runTimeInformation.stepSize/rate);
-    double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-    double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-    applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-    Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
+    forward_fft_engine(fftEngine,frame,outReal,outImag);
 
     //audio preprocessing
-    getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
+    getPowerSpectrum(amps,outReal,outImag,0,numFrequencyBins);
+    getLogarithmicSpectrum(amps,amps,numFrequencyBins);
     //applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
     insertIntoCSVFile(csvFileName, amps, runTimeInformation.sampleSize, currentTime);
 
     //printf("Detected %f Hz frequency (%s) with amplitude %f.\n",frequency,musicalNote,amplitude);
-    free(actualoutreal);
-    free(actualoutimag);
     //chunkIndex = 0;
     runTimeInformation.quit = currentTime > runTimeInformation.recordingTime;
   }
@@ -887,9 +969,11 @@ void buildAudioSpectrogram(char *wavFileName, char *csvFileName){
   }
   free(startPythonScriptCommand);
   free(buff);
-  free(inputReal);
-  free(inputImag);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
   free(amps);
+  close_fft_engine(fftEngine);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -914,9 +998,32 @@ void sequentialVersion(char *pcmDeviceName){
   initCapturedDataPoints(&capturedDataPoints);
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int numFrequencyBins = runTimeInformation.sampleSize/2 + 1;
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, runTimeInformation.sampleSize, runTimeInformation.stepSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  struct fft_engine *fftEngine;
+  if (!open_fft_engine(&fftEngine, runTimeInformation.fftEngine, runTimeInformation.sampleSize)) {
+    fail();
+  }
+  sample_t *frame = input_fft_engine(fftEngine);
+  int minBin, maxBin;
+  SpectralPeak peak;
+  getBandpassBins(&minBin, &maxBin, runTimeInformation.sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
+  NoteBank noteBank;
+  ConstantQTransform constantQ;
+  int useConstantQ = strcmp(runTimeInformation.spectralAnalyzer, "constant-q") == 0;
+  int useNoteBank = !useConstantQ && strcmp(runTimeInformation.spectralAnalyzer, "fft") != 0;
+  int interpolatePeak = !useNoteBank && !useConstantQ && runTimeInformation.peakInterpolation;
+  if (useNoteBank && !initNoteBank(&noteBank, runTimeInformation.spectralAnalyzer, runTimeInformation.sampleSize, runTimeInformation.stepSize, rate, runTimeInformation.tuningPitch, runTimeInformation.noteBankNeighbours, runTimeInformation.windowingFunction, runTimeInformation.kaiserBeta)) {
+    fail();
+  }
+  if (useConstantQ && !initConstantQTransform(&constantQ, runTimeInformation.fftEngine, runTimeInformation.sampleSize, runTimeInformation.stepSize, rate, runTimeInformation.tuningPitch, runTimeInformation.constantQBinsPerOctave)) {
+    fail();
+  }
 
   struct timespec start_t, current_t;
 
@@ -940,14 +1047,12 @@ void sequentialVersion(char *pcmDeviceName){
         msleep(sleepTime);
     }
   }
-  runTimeInformation.isCapturingAudio = 1;
+  setFlag(&runTimeInformation.isCapturingAudio, 1);
 
   pthread_create(&metronomeThread,NULL,metronome_entry_point,BEAT_AUDIO_FILE);
 
   if (runTimeInformation.melodyBenchmarking) {
-    while (!runTimeInformation.isMidiFilePlaying) {
-      msleep(5);
-    }
+    waitFlag(&runTimeInformation.isMidiFilePlaying, TRUE);
   }
 
   clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
@@ -957,12 +1062,10 @@ void sequentialVersion(char *pcmDeviceName){
   runTimeInformation.quit = currentTime > runTimeInformation.recordingTime*1000;
 
   //char *musicalExpression = "";
-	double lastTime = currentTime;
-	char *lastNote = "";
-  char *currentNote = "";
-	double duration = 0;
+  NoteTracker noteTracker;
+  initNoteTracker(&noteTracker, 1000.0 * runTimeInformation.stepSize / rate);
+  NoteEvent noteEvent;
   float decibel = -60.0;
-  int oldBin = 0;
 
   runs = 0;
   fftRunTime = 0;
@@ -976,66 +1079,46 @@ void sequentialVersion(char *pcmDeviceName){
       clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_capture_t);
       if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
         memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-      shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
+      const sample_t *inputReal = stageFrame(&frameStager, buff, useNoteBank || useConstantQ ? NULL : frame);
       clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
       audioCaptureTime += (current_time_t.tv_sec - start_audio_capture_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_capture_t.tv_nsec)/1000000.0;
 
       //Audio Preprocessing
       clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_preprocessing_t);
-      double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-      double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-
-      applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-
-      clock_gettime(CLOCK_MONOTONIC_RAW,&fft_run_start_t);
-      Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-      fftRunTime += (current_time_t.tv_sec - fft_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - fft_run_start_t.tv_nsec)/1000000.0;
-
-      getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-      applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+      if (useNoteBank || useConstantQ) {
+        clock_gettime(CLOCK_MONOTONIC_RAW,&fft_run_start_t);
+        if (useNoteBank) {
+          analyzeNoteBank(&noteBank,inputReal,amps);
+        } else {
+          analyzeConstantQ(&constantQ,inputReal,amps);
+        }
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
+        fftRunTime += (current_time_t.tv_sec - fft_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - fft_run_start_t.tv_nsec)/1000000.0;
+        applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+      } else {
+        clock_gettime(CLOCK_MONOTONIC_RAW,&fft_run_start_t);
+        forward_fft_engine(fftEngine,frame,outReal,outImag);
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
+        fftRunTime += (current_time_t.tv_sec - fft_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - fft_run_start_t.tv_nsec)/1000000.0;
+
+        findSpectralPeak(&peak,outReal,outImag,minBin,maxBin,runTimeInformation.sampleSize);
+      }
 
       clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
       audioPreProcessingTime += (current_time_t.tv_sec - start_audio_preprocessing_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_preprocessing_t.tv_nsec)/1000000.0;
 
       //Audio Transcription
       clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_transcription_t);
-      int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
+      int frequencyBin = useNoteBank || useConstantQ ? getFrequencyBin(amps,runTimeInformation.sampleSize) : peak.bin;
       //double amplitude = amps[frequencyBin];
-      double frequency = (double)frequencyBin * rate/runTimeInformation.sampleSize;
-      currentNote = getMusicalNote(frequency,runTimeInformation.tuningPitch,runTimeInformation.pitchResolutionInCents);
-
-      duration = currentTime - lastTime;
-      //if(duration > 0 && strcmp(currentNote, lastNote)!=0 && strcmp(currentNote, "")!=0){
-      if(duration > (60.0*1000)/(runTimeInformation.beatsPerMinute*(RHYTHM_RESOLUTION/RHYTHM_DENOMINATOR)) && strcmp(currentNote, lastNote)!=0){
-        double freq = oldBin * rate/runTimeInformation.sampleSize;
-        char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-        char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-        if (strlen(currentExpression)>0) {
-          MusicalDataPoint dP;
-          initMusicalDataPoint(&dP, freq, duration, decibel);
-          insertMusicalDataPoint(&capturedDataPoints, dP);
-          //musicalExpression = append(musicalExpression, currentExpression);
-          //musicalExpression = append(musicalExpression, " ");
-
-          if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-            printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-          }
-          lastTime = currentTime;
-          lastNote = currentNote;
-        }
-
-        oldBin = frequencyBin;
-        duration = 0;
-
-        free(musicalNote);
-        free(currentExpression);
+      double position = interpolatePeak ? getPeakPosition(&peak) : frequencyBin;
+      double frequency = useConstantQ ? getConstantQFrequency(&constantQ,frequencyBin) : position * rate/runTimeInformation.sampleSize;
+      int currentNote = useConstantQ || interpolatePeak ? getNoteOfBinPosition(noteTable,frequency*runTimeInformation.sampleSize/rate,NULL) : getNoteOfBin(noteTable,frequencyBin,NULL);
+      if (updateNoteTracker(&noteTracker, currentNote, frequency, currentTime, &noteEvent)) {
+        insertNoteEvent(&noteEvent, &capturedDataPoints, decibel);
       }
       clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
       audioTranscriptionTime += (current_time_t.tv_sec - start_audio_transcription_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_transcription_t.tv_nsec)/1000000.0;
-      free(actualoutreal);
-      free(actualoutimag);
 
       clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
   		currentTime = (current_t.tv_sec - start_t.tv_sec)*1000.0+ (current_t.tv_nsec - start_t.tv_nsec)/1000000.0;
@@ -1046,26 +1129,10 @@ void sequentialVersion(char *pcmDeviceName){
       runTime += (current_time_t.tv_sec - single_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - single_run_start_t.tv_nsec)/1000000.0;
       runs++;
   }
-  runTimeInformation.isCapturingAudio = 0;
+  setFlag(&runTimeInformation.isCapturingAudio, 0);
   pthread_join(metronomeThread,NULL);
-  if(duration > 0){
-    double freq = oldBin * rate/runTimeInformation.sampleSize;
-    char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-    char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-    MusicalDataPoint dP;
-    initMusicalDataPoint(&dP, freq, duration, decibel);
-    insertMusicalDataPoint(&capturedDataPoints, dP);
-    //musicalExpression = append(musicalExpression, currentExpression);
-    //musicalExpression = append(musicalExpression, " ");
-    if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-      printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-    }
-    lastNote = currentNote;
-    oldBin = 0;
-    duration = 0;
-    free(musicalNote);
-    free(currentExpression);
+  if (finishNoteTracker(&noteTracker, currentTime, &noteEvent)) {
+    insertNoteEvent(&noteEvent, &capturedDataPoints, decibel);
   }
   clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
   if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
@@ -1087,9 +1154,17 @@ void sequentialVersion(char *pcmDeviceName){
   }
   freeCapturedDataPoints(&capturedDataPoints);
   free(buff);
-  free(inputReal);
-  free(inputImag);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
   free(amps);
+  if (useNoteBank) {
+    freeNoteBank(&noteBank);
+  }
+  if (useConstantQ) {
+    freeConstantQTransform(&constantQ);
+  }
+  close_fft_engine(fftEngine);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -1114,20 +1189,22 @@ void readWAVFile(char *wavFileName){
   initCapturedDataPoints(&capturedDataPoints);
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int firstCore = runTimeInformation.pinPipelineThreads ? 1 : -1;
+  if (!initFrameAnalysisPool(&frameAnalysisPool, &runTimeInformation, rate, runTimeInformation.frameAnalysisWorkers, firstCore)) {
+    fail();
+  }
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
 
   double currentTime = 0;
   runTimeInformation.quit = currentTime > runTimeInformation.recordingTime;
 
   //char *musicalExpression = "";
-  double lastTime = currentTime;
-	char *lastNote = "";
-  char *currentNote = "";
-	double duration = 0;
+  NoteTracker noteTracker;
+  initNoteTracker(&noteTracker, 1000.0 * runTimeInformation.stepSize / rate);
+  NoteEvent noteEvent;
   float decibel = -60.0;
-  int oldBin = 0;
+  int currentNote = NO_MIDI_NOTE;
+  double frequency = 0;
 
   runs = 0;
   fftRunTime = 0;
@@ -1136,95 +1213,53 @@ void readWAVFile(char *wavFileName){
   audioPreProcessingTime = 0;
   audioTranscriptionTime = 0;
 
+  //the frames are analyzed by the threads of the pool, the spectral frames that are ready are tracked after every hop
+  const SpectralFrame *spectralFrame;
+  clock_gettime(CLOCK_MONOTONIC_RAW,&single_run_start_t);
   while(!runTimeInformation.quit) {
-    clock_gettime(CLOCK_MONOTONIC_RAW,&single_run_start_t);
     clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_capture_t);
     if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
       memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-    shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
     clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
     audioCaptureTime += (current_time_t.tv_sec - start_audio_capture_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_capture_t.tv_nsec)/1000000.0;
 
     currentTime += 1000 * runTimeInformation.stepSize/rate;
-    //Audio Preprocessing
-    clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_preprocessing_t);
-    double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-    double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-
-    applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-
-    clock_gettime(CLOCK_MONOTONIC_RAW,&fft_run_start_t);
-    Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-    clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-    fftRunTime += (current_time_t.tv_sec - fft_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - fft_run_start_t.tv_nsec)/1000000.0;
-
-    getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-    applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
-
-    clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-    audioPreProcessingTime += (current_time_t.tv_sec - start_audio_preprocessing_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_preprocessing_t.tv_nsec)/1000000.0;
-
-    //Audio Transcription
+    if (isFrameAnalysisPoolFull(&frameAnalysisPool)) {
+      spectralFrame = waitSpectralFrame(&frameAnalysisPool);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_transcription_t);
+      trackSpectralFrame(spectralFrame, noteTable, &noteTracker, &currentNote, &frequency, &capturedDataPoints);
+      releaseSpectralFrame(&frameAnalysisPool);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
+      audioTranscriptionTime += (current_time_t.tv_sec - start_audio_transcription_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_transcription_t.tv_nsec)/1000000.0;
+      runs++;
+    }
+    submitFrame(&frameAnalysisPool, buff, currentTime, 0);
     clock_gettime(CLOCK_MONOTONIC_RAW,&start_audio_transcription_t);
-    int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
-    //double amplitude = amps[frequencyBin];
-    double frequency = (double)frequencyBin * rate/runTimeInformation.sampleSize;
-    currentNote = getMusicalNote(frequency,runTimeInformation.tuningPitch,runTimeInformation.pitchResolutionInCents);
-
-    duration = currentTime - lastTime;
-    if(duration > (60.0*1000)/(runTimeInformation.beatsPerMinute*(RHYTHM_RESOLUTION/RHYTHM_DENOMINATOR)) && strcmp(currentNote, lastNote)!=0 && strcmp(currentNote, "") != 0){
-      double freq = oldBin * rate/runTimeInformation.sampleSize;
-      char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-      char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-      if (strlen(currentExpression)>0) {
-        MusicalDataPoint dP;
-        initMusicalDataPoint(&dP, freq, duration, decibel);
-        insertMusicalDataPoint(&capturedDataPoints, dP);
-        //musicalExpression = append(musicalExpression, currentExpression);
-        //musicalExpression = append(musicalExpression, " ");
-
-        if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-          printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-        }
-        lastTime = currentTime;
-        lastNote = currentNote;
-      }
-      oldBin = frequencyBin;
-      duration = 0;
-      free(musicalNote);
-      free(currentExpression);
+    while ((spectralFrame = peekSpectralFrame(&frameAnalysisPool)) != NULL) {
+      trackSpectralFrame(spectralFrame, noteTable, &noteTracker, &currentNote, &frequency, &capturedDataPoints);
+      releaseSpectralFrame(&frameAnalysisPool);
+      runs++;
     }
     clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
     audioTranscriptionTime += (current_time_t.tv_sec - start_audio_transcription_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - start_audio_transcription_t.tv_nsec)/1000000.0;
 
-    free(actualoutreal);
-    free(actualoutimag);
-
     runTimeInformation.quit = currentTime > runTimeInformation.recordingTime * 1000;
-    //-----
-    clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-    runTime += (current_time_t.tv_sec - single_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - single_run_start_t.tv_nsec)/1000000.0;
+  }
+  closeFrameAnalysisPool(&frameAnalysisPool);
+  while ((spectralFrame = waitSpectralFrame(&frameAnalysisPool)) != NULL) {
+    trackSpectralFrame(spectralFrame, noteTable, &noteTracker, &currentNote, &frequency, &capturedDataPoints);
+    releaseSpectralFrame(&frameAnalysisPool);
     runs++;
   }
-  if(duration > 0){
-    double freq = oldBin * rate/runTimeInformation.sampleSize;
-    char *musicalNote = getMusicalNote(freq,runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
-    char *currentExpression = calculateNoteLength(musicalNote,duration,runTimeInformation.pitchResolutionInCents,runTimeInformation.beatsPerMinute,RHYTHM_DENOMINATOR);
-
-    MusicalDataPoint dP;
-    initMusicalDataPoint(&dP, freq, duration, decibel);
-    insertMusicalDataPoint(&capturedDataPoints, dP);
-    //musicalExpression = append(musicalExpression, currentExpression);
-    //musicalExpression = append(musicalExpression, " ");
-    if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
-      printf("Current Time: %f - %f (%s) - Duration:%f\n",currentTime, freq, currentExpression, duration);
-    }
-    lastNote = currentNote;
-    oldBin = 0;
-    duration = 0;
-    free(musicalNote);
-    free(currentExpression);
+  clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
+  runTime = (current_time_t.tv_sec - single_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - single_run_start_t.tv_nsec)/1000000.0;
+  getFrameAnalysisTimes(&frameAnalysisPool, &analysisStageTime, &audioPreProcessingTime, &fftRunTime);
+  spectralStageTime = frameAnalysisPool.stagingTime;
+  audioPreProcessingTime += spectralStageTime;
+  analysisWorkers = frameAnalysisPool.numWorkers;
+
+  if (finishNoteTracker(&noteTracker, currentTime, &noteEvent)) {
+    insertNoteEvent(&noteEvent, &capturedDataPoints, decibel);
   }
   if (!runTimeInformation.timeBenchmarking && !runTimeInformation.melodyBenchmarking) {
     char *musicalExpression = (char *)calloc(32, sizeof(char));
@@ -1245,9 +1280,7 @@ void readWAVFile(char *wavFileName){
   }
   freeCapturedDataPoints(&capturedDataPoints);
   free(buff);
-  free(inputReal);
-  free(inputImag);
-  free(amps);
+  freeFrameAnalysisPool(&frameAnalysisPool);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -1296,14 +1329,12 @@ void writeWAVFile(char *soundCardName, char *wavFileName){
         msleep(sleepTime);
     }
   }
-  runTimeInformation.isCapturingAudio = 1;
+  setFlag(&runTimeInformation.isCapturingAudio, 1);
   pthread_create(&metronomeThread,NULL,metronome_entry_point,BEAT_AUDIO_FILE);
 
 
   if (runTimeInformation.melodyBenchmarking) {
-    while (!runTimeInformation.isMidiFilePlaying) {
-      msleep(5);
-    }
+    waitFlag(&runTimeInformation.isMidiFilePlaying, TRUE);
   }
 
   struct timespec start_t, current_t;
@@ -1322,7 +1353,7 @@ void writeWAVFile(char *soundCardName, char *wavFileName){
     clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
     runTimeInformation.quit = (current_t.tv_sec - start_t.tv_sec)*1000.0+ (current_t.tv_nsec - start_t.tv_nsec)/1000000.0 > runTimeInformation.recordingTime*1000;
   }
-  runTimeInformation.isCapturingAudio = 0;
+  setFlag(&runTimeInformation.isCapturingAudio, 0);
   pthread_join(metronomeThread,NULL);
   free(buff);
   close_pcm(pcm);
@@ -1337,19 +1368,17 @@ command.
 @see https://wiki.ubuntuusers.de/TiMidity/
 **/
 void *playing_midi_file_entry(void *arg){
-    runTimeInformation.isMidiFilePlaying = TRUE;
+    setFlag(&runTimeInformation.isMidiFilePlaying, TRUE);
     char *midiFile = (char *)arg;
     char *playMidiCommand = (char *) calloc(strlen("timidity ") + strlen(midiFile) + sizeof(NULL),sizeof(char));
     strcpy(playMidiCommand,"timidity ");
     strcat(playMidiCommand,midiFile);
-    while(!runTimeInformation.isCapturingAudio){
-        msleep(5);
-    }
+    waitFlag(&runTimeInformation.isCapturingAudio, 1);
     retError = system(playMidiCommand);
     if (retError == -1) {
       fail();
     }
-    runTimeInformation.isMidiFilePlaying = FALSE;
+    setFlag(&runTimeInformation.isMidiFilePlaying, FALSE);
     free(playMidiCommand);
     return NULL;
 }
@@ -1404,9 +1433,20 @@ void noteBenchmarking(char *soundCardName){
   __isRecording = 1;
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int numFrequencyBins = runTimeInformation.sampleSize/2 + 1;
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, runTimeInformation.sampleSize, runTimeInformation.stepSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  struct fft_engine *fftEngine;
+  if (!open_fft_engine(&fftEngine, runTimeInformation.fftEngine, runTimeInformation.sampleSize)) {
+    fail();
+  }
+  sample_t *frame = input_fft_engine(fftEngine);
+  int minBin, maxBin;
+  getBandpassBins(&minBin, &maxBin, runTimeInformation.sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
 
   int numNotesPerOctave = 12;
   char musicalNotes[][12]={
@@ -1439,22 +1479,17 @@ void noteBenchmarking(char *soundCardName){
       while(!runTimeInformation.quit){
           if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
             memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-          shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
-
-          double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-          double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-          applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-          Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
+          stageFrame(&frameStager, buff, frame);
+          forward_fft_engine(fftEngine,frame,outReal,outImag);
 
           //audio preprocessing
-          getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-          applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+          getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
 
           //audio processing
-          getBins(bins,numBins,amps,runTimeInformation.sampleSize,rate,runTimeInformation.tuningPitch);
+          int numFound = getPeakBins(bins,numBins,amps,noteTable);
           //int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
 
-          for (int i = 0; i < numBins; i++) {
+          for (int i = 0; i < numFound; i++) {
             //double amplitude = amps[bins[i]];
             double frequency = (double)bins[i] * rate/runTimeInformation.sampleSize;
             double centDifference = fabs(1200 * log(frequency/testFrequency)/log(2));
@@ -1468,11 +1503,6 @@ void noteBenchmarking(char *soundCardName){
               }
             }
           }
-          free(actualoutreal);
-          free(actualoutimag);
-          for (int i = 0; i < numBins; i++) {
-            bins[i] = 0;
-          }
           __isRecording = runTimeInformation.quit;
       }
       pthread_join(frequencyGeneratorTool,NULL);
@@ -1488,9 +1518,11 @@ void noteBenchmarking(char *soundCardName){
   free(testFrequencies);
   free(bins);
   free(buff);
-  free(inputReal);
-  free(inputImag);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
   free(amps);
+  close_fft_engine(fftEngine);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -1587,9 +1619,20 @@ void chordBenchmarking(char *soundCardName){
   __isRecording = 1;
 
   short *buff = (short *)calloc(runTimeInformation.stepSize,sizeof(short));
-  double *amps = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputReal = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
-  double *inputImag = (double *)calloc(runTimeInformation.sampleSize,sizeof(double));
+  int numFrequencyBins = runTimeInformation.sampleSize/2 + 1;
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, runTimeInformation.sampleSize, runTimeInformation.stepSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  struct fft_engine *fftEngine;
+  if (!open_fft_engine(&fftEngine, runTimeInformation.fftEngine, runTimeInformation.sampleSize)) {
+    fail();
+  }
+  sample_t *frame = input_fft_engine(fftEngine);
+  int minBin, maxBin;
+  getBandpassBins(&minBin, &maxBin, runTimeInformation.sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  const NoteTable *noteTable = getNoteTable(runTimeInformation.sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
 
   //int numNotesPerOctave = 12;
   char musicalNotes[][12]={
@@ -1663,38 +1706,23 @@ void chordBenchmarking(char *soundCardName){
             }*/
             if (!read_pcm(pcm, buff, runTimeInformation.stepSize))
               memset(buff, 0, sizeof(short) * channels * runTimeInformation.stepSize);
-            shiftWrite(inputReal, buff, runTimeInformation.sampleSize, runTimeInformation.stepSize);
-
-            double *actualoutreal = copyArray(inputReal,runTimeInformation.sampleSize*sizeof(double));
-            double *actualoutimag = copyArray(inputImag,runTimeInformation.sampleSize*sizeof(double));
-            applyWindowingFunction(actualoutreal,runTimeInformation.sampleSize,runTimeInformation.windowingFunction);
-            Fft_transform(actualoutreal,actualoutimag,runTimeInformation.sampleSize);
+            stageFrame(&frameStager, buff, frame);
+            forward_fft_engine(fftEngine,frame,outReal,outImag);
 
             //audio preprocessing
-            getFrequencySpectrum(amps,actualoutreal,actualoutimag,runTimeInformation.sampleSize);
-            applyFrequencyBandpass(amps,runTimeInformation.sampleSize,rate,LOW_FREQUENCY,HIGH_FREQUENCY);
+            getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
 
             //audio processing
-            getBins(bins,numBins,amps,runTimeInformation.sampleSize,rate,runTimeInformation.tuningPitch);
+            int numFound = getPeakBins(bins,numBins,amps,noteTable);
             //int frequencyBin = getFrequencyBin(amps,runTimeInformation.sampleSize);
 
-            for (int i = numBins; i > 1; --i) {
-              for (int j = 0; j < i-1; ++j) {
-                if (bins[j] > bins[j+1]) {
-                  double temp = bins[j];
-                  bins[j] = bins[j+1];
-                  bins[j+1] = temp;
-                }
-              }
-            }
-
             for (int i = 0; i < numBins; i++) {
               //double amplitude = amps[bins[i]];a
               double minCentDiff = INFINITY;
               double bestFreq = 0;
               double frequency = 0;
               double centDifference = 0;
-              for (int j = 0; j < numBins; j++) {
+              for (int j = 0; j < numFound; j++) {
                 frequency = (double)bins[j] * rate/runTimeInformation.sampleSize;
                 centDifference = fabs(1200 * log(frequency/testFrequencies[i])/log(2));
                 if (centDifference < minCentDiff) {
@@ -1738,11 +1766,6 @@ void chordBenchmarking(char *soundCardName){
             if (chordDetected) {
               runTimeInformation.quit = 1;
             }
-            free(actualoutreal);
-            free(actualoutimag);
-            for (int i = 0; i < numBins; i++) {
-              bins[i] = 0;
-            }
             __isRecording = runTimeInformation.quit;
         }
         pthread_join(frequencyGeneratorTool,NULL);
@@ -1764,9 +1787,11 @@ void chordBenchmarking(char *soundCardName){
 
 
   free(buff);
-  free(inputReal);
-  free(inputImag);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
   free(amps);
+  close_fft_engine(fftEngine);
   close_pcm(pcm);
   runTimeInformation.quit = 0;
 }
@@ -1877,6 +1902,10 @@ void melodyBenchmarking(char *soundCardName){
       plank_taper,
       blackman_harris
   };
+  //the coefficients of every window are calculated once and shared by all runs of the sweep
+  for (int i = 0; i < numWindowingFunctions; i++) {
+    getWindowCoefficients(getWindowingFunction(windowFunctions[i]), runTimeInformation.sampleSize, runTimeInformation.kaiserBeta);
+  }
 
   fp = fopen(csvFile,"a+");
   fclose(fp);
@@ -1909,25 +1938,16 @@ void melodyBenchmarking(char *soundCardName){
           pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
           sequentialVersion(soundCardName);
           pthread_join(playMidiThread,NULL);
-          while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-            msleep(10);
-          }
 
           benchmarkingMode = "threaded";
           pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
           threadedRealTimeVersion(soundCardName);
           pthread_join(playMidiThread,NULL);
-          while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-            msleep(10);
-          }
 
           benchmarkingMode = "post";
           pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
           writeWAVFile(soundCardName, runTimeInformation.wavFileName);
           pthread_join(playMidiThread,NULL);
-          while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-            msleep(10);
-          }
           readWAVFile(runTimeInformation.wavFileName);
           //compareCapturedDataToOriginal(str,de->d_name,csvFile);
 
@@ -1995,25 +2015,16 @@ void melodyBenchmarking(char *soundCardName){
                 pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
                 sequentialVersion(soundCardName);
                 pthread_join(playMidiThread,NULL);
-                while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-                  msleep(10);
-                }
 
                 benchmarkingMode = "threaded";
                 pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
                 threadedRealTimeVersion(soundCardName);
                 pthread_join(playMidiThread,NULL);
-                while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-                  msleep(10);
-                }
 
                 benchmarkingMode = "post";
                 pthread_create(&playMidiThread,NULL,playing_midi_file_entry,midiFile);
                 writeWAVFile(soundCardName, runTimeInformation.wavFileName);
                 pthread_join(playMidiThread,NULL);
-                while (runTimeInformation.isCapturingAudio || runTimeInformation.isMidiFilePlaying) {
-                  msleep(10);
-                }
                 readWAVFile(runTimeInformation.wavFileName);
                 //compareCapturedDataToOriginal(str,de->d_name,csvFile);
 
@@ -2037,6 +2048,708 @@ void melodyBenchmarking(char *soundCardName){
   fclose(fp);
 }
 
+/**
+@brief This function fills a frame with a synthetic test signal.
+Two sine waves and a small amount of noise are mixed, such that every bin of the spectrum is occupied.
+@param frame the array to fill
+@param sampleSize the number of samples in the frame
+**/
+void fillBenchmarkingFrame(double *frame, int sampleSize){
+  for (int i = 0; i < sampleSize; i++) {
+    frame[i] = 0.5 * sin(2 * M_PI * 440.0 * i / SAMPLE_RATE) + 0.25 * sin(2 * M_PI * 1234.5 * i / SAMPLE_RATE) + 0.01 * ((double)rand() / RAND_MAX - 0.5);
+  }
+}
+
+/**
+@brief This function benchmarks the computational kernels of the pipeline in isolation.
+No audio is captured. Every kernel runs repeatedly on a synthetic frame for the sample sizes of the
+performance benchmark sweep and of the detection modes. The average time per frame in milliseconds is written
+to '../output/kernelBenchmarking.csv'. The maximal error is measured against the reference fft, which always
+runs in double precision, such that it also shows the error of a single precision build.
+**/
+void kernelBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/kernelBenchmarking.csv","w");
+  fprintf(fp, "benchmark;variant;sampleSize;iterations;timePerFrame;maxError\n");
+  struct timespec start_t, current_t;
+
+  //powers of two and frame sizes that need Bluestein's algorithm, e.g. 4410 samples are 100ms at 44.1kHz
+  int sampleSizes[] = {128, 256, 512, 1024, 2048, 4096, 8192, 16384, 1000, 2205, 4410, 11025};
+  for (size_t s = 0; s < sizeof(sampleSizes)/sizeof(sampleSizes[0]); s++) {
+    int sampleSize = sampleSizes[s];
+    int iterations = (1 << 22) / sampleSize;
+    double *signal = (double *)calloc(sampleSize,sizeof(double));
+    double *zeros = (double *)calloc(sampleSize,sizeof(double));
+    double *referenceReal = (double *)calloc(sampleSize,sizeof(double));
+    double *referenceImag = (double *)calloc(sampleSize,sizeof(double));
+    sample_t *frame = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    sample_t *real = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    sample_t *imag = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    fillBenchmarkingFrame(signal, sampleSize);
+    for (int i = 0; i < sampleSize; i++) {
+      frame[i] = signal[i];
+    }
+
+    //reference: trigonometric tables, bit reversal and Bluestein chirp are rebuilt for every frame
+    double referenceTime = 0;
+    for (int i = 0; i < iterations; i++) {
+      memcpy(referenceReal, signal, sampleSize*sizeof(double));
+      memcpy(referenceImag, zeros, sampleSize*sizeof(double));
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      if ((sampleSize & (sampleSize - 1)) == 0) {
+        Fft_transformRadix2(referenceReal, referenceImag, sampleSize);
+      } else {
+        Fft_transformBluestein(referenceReal, referenceImag, sampleSize);
+      }
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      referenceTime += getElapsedMilliseconds(&start_t, &current_t);
+    }
+    fprintf(fp, "%s;%s;%d;%d;%f;%e\n","fft","reference",sampleSize,iterations,referenceTime/iterations,0.0);
+
+    //planned: tables are computed once per size and reused for every frame, every kernel of this processor is measured
+    FftPlan *fftPlan = Fft_getPlan(sampleSize);
+    FftKernel plannedKernel = fftPlan->kernel;
+    double plannedTime = 0;
+    double maxError = 0;
+    for (FftKernel kernel = 0; kernel < FFT_NUM_KERNELS; kernel++) {
+      if (!Fft_setKernel(fftPlan, kernel)) {
+        continue;
+      }
+      double kernelTime = 0;
+      for (int i = 0; i < iterations; i++) {
+        memcpy(real, frame, sampleSize*sizeof(sample_t));
+        memset(imag, 0, sampleSize*sizeof(sample_t));
+        clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+        Fft_transformPlanned(fftPlan, real, imag);
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+        kernelTime += getElapsedMilliseconds(&start_t, &current_t);
+      }
+      maxError = 0;
+      for (int i = 0; i < sampleSize; i++) {
+        maxError = fmax(maxError, fmax(fabs(real[i]-referenceReal[i]), fabs(imag[i]-referenceImag[i])));
+      }
+      fprintf(fp, "%s;%s;%d;%d;%f;%e\n","fft",Fft_getKernelName(kernel),sampleSize,iterations,kernelTime/iterations,maxError);
+      printf("%d - %s: %fms\n", sampleSize, Fft_getKernelName(kernel), kernelTime/iterations);
+      if (kernel == plannedKernel) {
+        plannedTime = kernelTime;
+      }
+    }
+    Fft_setKernel(fftPlan, plannedKernel);
+
+    //real: the frame is packed into a complex fft of half the size, only sampleSize/2+1 bins are calculated
+    double realTime = 0;
+    for (int i = 0; i < iterations; i++) {
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      Fft_transformReal(fftPlan, frame, real, imag);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      realTime += getElapsedMilliseconds(&start_t, &current_t);
+    }
+    maxError = 0;
+    for (int i = 0; i <= sampleSize/2; i++) {
+      maxError = fmax(maxError, fmax(fabs(real[i]-referenceReal[i]), fabs(imag[i]-referenceImag[i])));
+    }
+    fprintf(fp, "%s;%s;%d;%d;%f;%e\n","fft","real",sampleSize,iterations,realTime/iterations,maxError);
+
+    //engines: the real transform of every fft engine, as used by the frame loops
+    char *fftEngines[] = {"builtin", "fftw"};
+    for (size_t engine = 0; engine < sizeof(fftEngines)/sizeof(fftEngines[0]); engine++) {
+      struct fft_engine *fftEngine;
+      if (!open_fft_engine(&fftEngine, fftEngines[engine], sampleSize)) {
+        continue;
+      }
+      double engineTime = 0;
+      for (int i = 0; i < iterations; i++) {
+        clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+        forward_fft_engine(fftEngine, frame, real, imag);
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+        engineTime += getElapsedMilliseconds(&start_t, &current_t);
+      }
+      maxError = 0;
+      for (int i = 0; i <= sampleSize/2; i++) {
+        maxError = fmax(maxError, fmax(fabs(real[i]-referenceReal[i]), fabs(imag[i]-referenceImag[i])));
+      }
+      fprintf(fp, "%s;%s;%d;%d;%f;%e\n","engine",name_fft_engine(fftEngine),sampleSize,iterations,engineTime/iterations,maxError);
+      printf("%d - engine %s: %fms\n", sampleSize, name_fft_engine(fftEngine), engineTime/iterations);
+      close_fft_engine(fftEngine);
+    }
+    printf("%d - reference: %fms - planned (%s): %fms - real: %fms\n", sampleSize, referenceTime/iterations, Fft_getKernelName(plannedKernel), plannedTime/iterations, realTime/iterations);
+
+    free(signal);
+    free(frame);
+    free(zeros);
+    free(referenceReal);
+    free(referenceImag);
+    free(real);
+    free(imag);
+  }
+  Fft_freePlans();
+  fclose(fp);
+}
+
+/**
+@brief This function opens a hardware counter of the calling thread with perf_event_open.
+Only user space events are counted, such that the default setting of perf_event_paranoid allows it.
+@param type the perf event type, e.g. PERF_TYPE_HARDWARE
+@param config the event of that type, e.g. PERF_COUNT_HW_CACHE_MISSES
+@return fd the file descriptor of the disabled counter or -1 if the counter is not available
+**/
+int openPerfCounter(uint32_t type, uint64_t config){
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+@brief This function reads the value of a hardware counter.
+@param fd the file descriptor returned by openPerfCounter
+@return count the number of events or -1 if the counter is not available
+**/
+long long readPerfCounter(int fd){
+  long long count;
+  if (fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count)) {
+    return -1;
+  }
+  return count;
+}
+
+/**
+@brief This function compares the Stockham fft with the bit reversing radix-2 fft.
+For every sample size of the performance benchmark sweep (and 16384) the radix-2 kernel, the Stockham kernel and
+the default kernel of the plan run repeatedly on a synthetic frame. The wall time, the cache misses of the last
+level cache and the level 1 data cache read misses per transform are written to '../output/stockhamBenchmarking.csv'.
+The cache misses are -1 if the processor or the kernel does not provide the counters.
+**/
+void stockhamBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/stockhamBenchmarking.csv","w");
+  fprintf(fp, "kernel;sampleSize;iterations;timePerTransform;cacheMisses;l1dReadMisses;maxError\n");
+  struct timespec start_t, current_t;
+  int cacheMissCounter = openPerfCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  int l1dMissCounter = openPerfCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  if (cacheMissCounter < 0 || l1dMissCounter < 0) {
+    printf("%s\n", "Cache miss counters are not available, only the time is measured.");
+  }
+
+  for (int sampleSize = 128; sampleSize <= 16384; sampleSize *= 2) {
+    int iterations = (1 << 22) / sampleSize;
+    double *signal = (double *)calloc(sampleSize,sizeof(double));
+    double *referenceImag = (double *)calloc(sampleSize,sizeof(double));
+    sample_t *frame = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    sample_t *real = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    sample_t *imag = (sample_t *)calloc(sampleSize,sizeof(sample_t));
+    fillBenchmarkingFrame(signal, sampleSize);
+    for (int i = 0; i < sampleSize; i++) {
+      frame[i] = signal[i];
+    }
+    Fft_transformRadix2(signal, referenceImag, sampleSize);
+
+    FftPlan *fftPlan = Fft_getPlan(sampleSize);
+    FftKernel plannedKernel = fftPlan->kernel;
+    FftKernel kernels[] = {FFT_KERNEL_RADIX2, FFT_KERNEL_STOCKHAM, plannedKernel};
+    for (size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); k++) {
+      if (!Fft_setKernel(fftPlan, kernels[k])) {
+        continue;
+      }
+      //the counters only run during the transforms, copying the frame is not counted
+      double kernelTime = 0;
+      ioctl(cacheMissCounter, PERF_EVENT_IOC_RESET, 0);
+      ioctl(l1dMissCounter, PERF_EVENT_IOC_RESET, 0);
+      for (int i = 0; i < iterations; i++) {
+        memcpy(real, frame, sampleSize*sizeof(sample_t));
+        memset(imag, 0, sampleSize*sizeof(sample_t));
+        ioctl(cacheMissCounter, PERF_EVENT_IOC_ENABLE, 0);
+        ioctl(l1dMissCounter, PERF_EVENT_IOC_ENABLE, 0);
+        clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+        Fft_transformPlanned(fftPlan, real, imag);
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+        ioctl(cacheMissCounter, PERF_EVENT_IOC_DISABLE, 0);
+        ioctl(l1dMissCounter, PERF_EVENT_IOC_DISABLE, 0);
+        kernelTime += getElapsedMilliseconds(&start_t, &current_t);
+      }
+      long long cacheMisses = readPerfCounter(cacheMissCounter);
+      long long l1dMisses = readPerfCounter(l1dMissCounter);
+      double maxError = 0;
+      for (int i = 0; i < sampleSize; i++) {
+        maxError = fmax(maxError, fmax(fabs(real[i]-signal[i]), fabs(imag[i]-referenceImag[i])));
+      }
+      fprintf(fp, "%s;%d;%d;%f;%f;%f;%e\n",Fft_getKernelName(kernels[k]),sampleSize,iterations,kernelTime/iterations,cacheMisses < 0 ? -1.0 : (double)cacheMisses/iterations,l1dMisses < 0 ? -1.0 : (double)l1dMisses/iterations,maxError);
+      printf("%d - %s: %fms - cache misses: %.1f - l1d read misses: %.1f\n", sampleSize, Fft_getKernelName(kernels[k]), kernelTime/iterations, cacheMisses < 0 ? -1.0 : (double)cacheMisses/iterations, l1dMisses < 0 ? -1.0 : (double)l1dMisses/iterations);
+    }
+    Fft_setKernel(fftPlan, plannedKernel);
+
+    free(signal);
+    free(referenceImag);
+    free(frame);
+    free(real);
+    free(imag);
+  }
+  if (cacheMissCounter >= 0) {
+    close(cacheMissCounter);
+  }
+  if (l1dMissCounter >= 0) {
+    close(l1dMissCounter);
+  }
+  Fft_freePlans();
+  fclose(fp);
+}
+
+/**
+@brief This function measures how long the coefficients of every window take to be calculated and to be looked up.
+The cache of the windows is cleared first, such that the first request of a window for a sample size calculates it and
+the second one finds it in the cache. Both times in milliseconds are written to '../output/windowBenchmarking.csv'
+for the sample sizes of the performance benchmark sweep and 16384.
+**/
+void windowBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/windowBenchmarking.csv","w");
+  fprintf(fp, "windowingFunction;sampleSize;generationTime;lookupTime\n");
+  struct timespec start_t, current_t;
+  char *windowFunctions[] = {"rectangle", "hann", "hamming", "triangle", "parzen", "welch", "sine", "blackman-original",
+    "blackman-exact", "nuttall", "blackman-nuttall", "blackman-harris", "flattop", "rife-vincent", "gauss", "gauss-confined",
+    "tukey", "plank-taper", "kaiser", "dolph-chebyshev", "ultraspherical", "saramaeki", "exponential", "bartlett-hann",
+    "hann-poisson", "lanczos"};
+  freeWindowCoefficients();
+  for (size_t w = 0; w < sizeof(windowFunctions)/sizeof(windowFunctions[0]); w++) {
+    WindowingFunction windowingFunction = getWindowingFunction(windowFunctions[w]);
+    for (int sampleSize = 1024; sampleSize <= 16384; sampleSize *= 2) {
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      getWindowCoefficients(windowingFunction, sampleSize, runTimeInformation.kaiserBeta);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      double generationTime = getElapsedMilliseconds(&start_t, &current_t);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      getWindowCoefficients(windowingFunction, sampleSize, runTimeInformation.kaiserBeta);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      double lookupTime = getElapsedMilliseconds(&start_t, &current_t);
+      fprintf(fp, "%s;%d;%f;%f\n",windowFunctions[w],sampleSize,generationTime,lookupTime);
+      printf("%d - %s: generated in %fms, looked up in %fms\n", sampleSize, windowFunctions[w], generationTime, lookupTime);
+    }
+  }
+  freeWindowCoefficients();
+  fclose(fp);
+}
+
+/**
+@brief This function benchmarks the search of the loudest bin of the band in the fft data of a frame.
+The three passes of the melody modes before the fused kernel, logarithmic spectrum or power spectrum followed by
+applyFrequencyBandpass and getFrequencyBin, are compared with findSpectralPeak on the spectrum of a synthetic frame.
+The search of the loudest notes of the chord mode by getPeakBins is timed on the power spectrum of the same frame for 2, 6 and 10 notes.
+The average time per frame in milliseconds and the found bin are written to '../output/peakSearchBenchmarking.csv'.
+**/
+void peakSearchBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/peakSearchBenchmarking.csv","w");
+  fprintf(fp, "variant;sampleSize;iterations;timePerFrame;bin\n");
+  struct timespec start_t, current_t;
+  char *variants[] = {"logarithmic spectrum", "power spectrum", "fused"};
+  for (int sampleSize = 1024; sampleSize <= 16384; sampleSize *= 2) {
+    int iterations = (1 << 24) / sampleSize;
+    struct fft_engine *fftEngine;
+    if (!open_fft_engine(&fftEngine, "builtin", sampleSize)) {
+      continue;
+    }
+    int numFrequencyBins = sampleSize/2 + 1;
+    double *signal = (double *)calloc(sampleSize,sizeof(double));
+    sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *frame = input_fft_engine(fftEngine);
+    fillBenchmarkingFrame(signal, sampleSize);
+    for (int i = 0; i < sampleSize; i++) {
+      frame[i] = (sample_t)(64 * signal[i]);
+    }
+    forward_fft_engine(fftEngine,frame,outReal,outImag);
+    int minBin, maxBin;
+    getBandpassBins(&minBin, &maxBin, sampleSize, SAMPLE_RATE, LOW_FREQUENCY, HIGH_FREQUENCY);
+    double timePerFrame[3];
+    for (int variant = 0; variant < 3; variant++) {
+      int frequencyBin = 0;
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      for (int k = 0; k < iterations; k++) {
+        if (variant == 0) {
+          getFrequencySpectrum(amps,outReal,outImag,sampleSize);
+          applyFrequencyBandpass(amps,sampleSize,SAMPLE_RATE,LOW_FREQUENCY,HIGH_FREQUENCY);
+          frequencyBin = getFrequencyBin(amps,sampleSize);
+        } else if (variant == 1) {
+          getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
+          applyFrequencyBandpass(amps,sampleSize,SAMPLE_RATE,LOW_FREQUENCY,HIGH_FREQUENCY);
+          frequencyBin = getFrequencyBin(amps,sampleSize);
+        } else {
+          SpectralPeak peak;
+          findSpectralPeak(&peak,outReal,outImag,minBin,maxBin,sampleSize);
+          frequencyBin = peak.bin;
+        }
+      }
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      timePerFrame[variant] = getElapsedMilliseconds(&start_t, &current_t) / iterations;
+      fprintf(fp, "%s;%d;%d;%f;%d\n",variants[variant],sampleSize,iterations,timePerFrame[variant],frequencyBin);
+      printf("%d - %s: %fms per frame, bin %d\n", sampleSize, variants[variant], timePerFrame[variant], frequencyBin);
+    }
+    printf("%d - fused search saves %fms per frame against the power spectrum\n", sampleSize, timePerFrame[1] - timePerFrame[2]);
+    const NoteTable *noteTable = getNoteTable(sampleSize, SAMPLE_RATE, TUNING_PITCH, PITCH_RESOLUTION);
+    getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
+    for (int numNotes = 2; numNotes <= 10; numNotes += 4) {
+      int bins[10];
+      char variant[32];
+      sprintf(variant, "top %d notes", numNotes);
+      clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+      for (int k = 0; k < iterations; k++) {
+        getPeakBins(bins,numNotes,amps,noteTable);
+      }
+      clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+      double timePerSearch = getElapsedMilliseconds(&start_t, &current_t) / iterations;
+      fprintf(fp, "%s;%d;%d;%f;%d\n",variant,sampleSize,iterations,timePerSearch,bins[0]);
+      printf("%d - %s: %fms per frame, bin %d\n", sampleSize, variant, timePerSearch, bins[0]);
+    }
+    close_fft_engine(fftEngine);
+    free(signal);
+    free(amps);
+    free(outReal);
+    free(outImag);
+  }
+  fclose(fp);
+}
+
+/**
+@brief This function validates the note detection of the frame path on synthetic tones.
+The notes that the bin search of the chord mode can tell apart within the bandpass are quantized to 16 bit samples and run through
+the frame path of the note benchmarking (conversion, the configured window, fft, spectrum, bandpass and bin search) of every fft engine.
+A note is detected if the note of the loudest bin is the note of the tone.
+No audio is captured, such that the results of a single and a double precision build can be compared directly.
+The results are written to '../output/noteAccuracyBenchmarking.csv'.
+**/
+void noteAccuracyBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/noteAccuracyBenchmarking.csv","w");
+  fprintf(fp, "precision;fftEngine;note;octave;frequency;midiNote;detectedMidiNote;isNoteDetected\n");
+  char *precision = sizeof(sample_t) == sizeof(float) ? "single" : "double";
+  int sampleSize = 8192;
+  double rate = SAMPLE_RATE;
+  int numFrequencyBins = sampleSize/2 + 1;
+  int bins[1];
+  short *buff = (short *)calloc(sampleSize,sizeof(short));
+  sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  FrameStager frameStager;
+  initFrameStager(&frameStager, sampleSize, sampleSize, getWindowingFunction(runTimeInformation.windowingFunction), runTimeInformation.kaiserBeta);
+  sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+  int minBin, maxBin;
+  getBandpassBins(&minBin, &maxBin, sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+  const NoteTable *noteTable = getNoteTable(sampleSize, rate, runTimeInformation.tuningPitch, PITCH_RESOLUTION);
+  char musicalNotes[][12]={"c","cis","d","dis","e","f","fis","g","gis","a","ais","b"};
+
+  char *fftEngines[] = {"builtin", "fftw"};
+  for (size_t engine = 0; engine < sizeof(fftEngines)/sizeof(fftEngines[0]); engine++) {
+    struct fft_engine *fftEngine;
+    if (!open_fft_engine(&fftEngine, fftEngines[engine], sampleSize)) {
+      continue;
+    }
+    int numNotes = 0;
+    int numDetected = 0;
+    for (int note = 0; note < NUM_NOTE_BINS; note++) {
+      int bin = noteTable->noteBins[note];
+      if ((note > 0 && bin == noteTable->noteBins[note-1]) || bin < minBin || bin + 1 >= maxBin) {
+        continue;
+      }
+      int midiNote = NOTE_BINS_FIRST_MIDI_NOTE + note;
+      double testFrequency = runTimeInformation.tuningPitch * pow(2.0,(midiNote-69)/12.0);
+      for (int i = 0; i < sampleSize; i++) {
+        buff[i] = (short)(16384.0 * sin(2 * M_PI * testFrequency * i / rate));
+      }
+      sample_t *frame = input_fft_engine(fftEngine);
+      stageFrame(&frameStager, buff, frame);
+      forward_fft_engine(fftEngine,frame,outReal,outImag);
+      getPowerSpectrum(amps,outReal,outImag,minBin,maxBin);
+      int detectedMidiNote = NO_MIDI_NOTE;
+      if (getPeakBins(bins,1,amps,noteTable) > 0) {
+        for (int i = 0; i < NUM_NOTE_BINS && detectedMidiNote == NO_MIDI_NOTE; i++) {
+          if (noteTable->noteBins[i] == bins[0]) {
+            detectedMidiNote = NOTE_BINS_FIRST_MIDI_NOTE + i;
+          }
+        }
+      }
+      int isNoteDetected = detectedMidiNote == midiNote;
+      numNotes++;
+      numDetected += isNoteDetected;
+      fprintf(fp, "%s;%s;%s;%d;%f;%d;%d;%d\n",precision,name_fft_engine(fftEngine),musicalNotes[midiNote%12],midiNote/12-1,testFrequency,midiNote,detectedMidiNote,isNoteDetected);
+    }
+    printf("%s precision - engine %s: %d of %d notes detected\n", precision, name_fft_engine(fftEngine), numDetected, numNotes);
+    close_fft_engine(fftEngine);
+  }
+  free(buff);
+  free(amps);
+  freeFrameStager(&frameStager);
+  free(outReal);
+  free(outImag);
+  fclose(fp);
+}
+
+/**
+@brief This function measures the pitch accuracy of the melody modes against the latency of their frame size.
+Tones between a and c'''' that are detuned by up to 20 cents are quantized to 16 bit samples and run through the fft path of the melody
+modes (conversion, windowing, fft of the builtin engine, findSpectralPeak and note lookup) for the frame sizes 2048, 4096 and 8192 with
+the rectangle and the hann window, once with the bin of the peak and once with the parabolic interpolation of getPeakPosition.
+The latency of a frame, its average processing time, the number of detected notes and the mean and maximal cent difference
+of the measured frequency to the tone are written to '../output/noteLatencyBenchmarking.csv'.
+**/
+void noteLatencyBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/noteLatencyBenchmarking.csv","w");
+  fprintf(fp, "sampleSize;latency;window;interpolation;timePerFrame;numNotes;numDetected;meanCentDifference;maxCentDifference\n");
+  double rate = SAMPLE_RATE;
+  int firstNote = 57;
+  int numNotes = 40;
+  struct timespec start_t, current_t;
+  char *windows[] = {"rectangle", "hann"};
+  for (int sampleSize = 2048; sampleSize <= 8192; sampleSize *= 2) {
+    struct fft_engine *fftEngine;
+    if (!open_fft_engine(&fftEngine, "builtin", sampleSize)) {
+      continue;
+    }
+    int numFrequencyBins = sampleSize/2 + 1;
+    short *buff = (short *)calloc(sampleSize,sizeof(short));
+    sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *frame = input_fft_engine(fftEngine);
+    int minBin, maxBin;
+    getBandpassBins(&minBin, &maxBin, sampleSize, rate, LOW_FREQUENCY, HIGH_FREQUENCY);
+    const NoteTable *noteTable = getNoteTable(sampleSize, rate, runTimeInformation.tuningPitch, runTimeInformation.pitchResolutionInCents);
+    double latency = 1000.0 * sampleSize / rate;
+    for (size_t w = 0; w < sizeof(windows)/sizeof(windows[0]); w++) {
+      FrameStager frameStager;
+      initFrameStager(&frameStager, sampleSize, sampleSize, getWindowingFunction(windows[w]), runTimeInformation.kaiserBeta);
+      for (int interpolation = 0; interpolation <= 1; interpolation++) {
+        int numDetected = 0;
+        double sumCentDifference = 0;
+        double maxCentDifference = 0;
+        double processingTime = 0;
+        for (int note = firstNote; note < firstNote + numNotes; note++) {
+          double detune = 20 * sin(1.7 * note);
+          double testFrequency = runTimeInformation.tuningPitch * pow(2.0,(note - 69 + detune/100)/12.0);
+          for (int i = 0; i < sampleSize; i++) {
+            buff[i] = (short)(16384.0 * sin(2 * M_PI * testFrequency * i / rate));
+          }
+          clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+          stageFrame(&frameStager, buff, frame);
+          forward_fft_engine(fftEngine,frame,outReal,outImag);
+          SpectralPeak peak;
+          findSpectralPeak(&peak,outReal,outImag,minBin,maxBin,sampleSize);
+          double position = interpolation ? getPeakPosition(&peak) : peak.bin;
+          int midiNote = interpolation ? getNoteOfBinPosition(noteTable,position,NULL) : getNoteOfBin(noteTable,peak.bin,NULL);
+          clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+          processingTime += getElapsedMilliseconds(&start_t, &current_t);
+
+          double centDifference = fabs(1200 * log2(position * rate / sampleSize / testFrequency));
+          numDetected += midiNote == note;
+          sumCentDifference += centDifference;
+          maxCentDifference = fmax(maxCentDifference, centDifference);
+        }
+        fprintf(fp, "%d;%f;%s;%d;%f;%d;%d;%f;%f\n",sampleSize,latency,windows[w],interpolation,processingTime/numNotes,numNotes,numDetected,sumCentDifference/numNotes,maxCentDifference);
+        printf("%d (%fms latency) - %s window - interpolation %d: %d of %d notes detected, mean cent difference %f, maximal cent difference %f\n", sampleSize, latency, windows[w], interpolation, numDetected, numNotes, sumCentDifference/numNotes, maxCentDifference);
+      }
+      freeFrameStager(&frameStager);
+    }
+    close_fft_engine(fftEngine);
+    free(buff);
+    free(outReal);
+    free(outImag);
+  }
+  fclose(fp);
+}
+
+/**
+@brief This function compares the note bank analyzers with the fft path at small step sizes.
+A synthetic stream of 16 bit samples is cut into hops of stepSize samples. For every hop the fft path (windowing, real fft of
+the builtin engine and spectrum) or a note bank analyzer calculates the amplitudes of the note bins of the frame. The average time per
+hop in milliseconds and the maximal difference of the note bin amplitudes to the ones of the fft path after the last hop are written to
+'../output/noteBankBenchmarking.csv'. Only bins within 40dB of the loudest note bin are compared, the others are dominated by rounding.
+**/
+void noteBankBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/noteBankBenchmarking.csv","w");
+  fprintf(fp, "analyzer;windowingFunction;sampleSize;stepSize;iterations;timePerHop;maxDifference\n");
+  struct timespec start_t, current_t;
+  char *windowingFunction = "hann";
+  double rate = SAMPLE_RATE;
+  int iterations = 1024;
+
+  int sampleSizes[] = {2048, 4096, 8192};
+  int stepSizes[] = {16, 32, 64, 128, 256, 512};
+  char *analyzers[] = {"fft", "goertzel", "sliding-dft"};
+  for (size_t s = 0; s < sizeof(sampleSizes)/sizeof(sampleSizes[0]); s++) {
+    int sampleSize = sampleSizes[s];
+    int numFrequencyBins = sampleSize/2 + 1;
+    sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *referenceAmps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    struct fft_engine *fftEngine;
+    if (!open_fft_engine(&fftEngine, "builtin", sampleSize)) {
+      fail();
+    }
+    sample_t *frame = input_fft_engine(fftEngine);
+    for (size_t t = 0; t < sizeof(stepSizes)/sizeof(stepSizes[0]); t++) {
+      int stepSize = stepSizes[t];
+      short *buff = (short *)calloc(stepSize,sizeof(short));
+      FrameStager frameStager;
+      initFrameStager(&frameStager, sampleSize, stepSize, getWindowingFunction(windowingFunction), runTimeInformation.kaiserBeta);
+      for (size_t a = 0; a < sizeof(analyzers)/sizeof(analyzers[0]); a++) {
+        int useNoteBank = strcmp(analyzers[a], "fft") != 0;
+        NoteBank noteBank;
+        if (useNoteBank && !initNoteBank(&noteBank, analyzers[a], sampleSize, stepSize, rate, runTimeInformation.tuningPitch, runTimeInformation.noteBankNeighbours, windowingFunction, runTimeInformation.kaiserBeta)) {
+          continue;
+        }
+        resetFrameStager(&frameStager);
+        memset(amps, 0, numFrequencyBins*sizeof(sample_t));
+        double analyzerTime = 0;
+        for (int i = 0; i < iterations; i++) {
+          for (int n = 0; n < stepSize; n++) {
+            long sample = (long)i * stepSize + n;
+            buff[n] = (short)(8000.0 * sin(2 * M_PI * 440.0 * sample / rate) + 4000.0 * sin(2 * M_PI * 1234.5 * sample / rate));
+          }
+          clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+          const sample_t *inputReal = stageFrame(&frameStager, buff, useNoteBank ? NULL : frame);
+          if (useNoteBank) {
+            analyzeNoteBank(&noteBank,inputReal,amps);
+          } else {
+            forward_fft_engine(fftEngine,frame,outReal,outImag);
+            getPowerSpectrum(amps,outReal,outImag,0,numFrequencyBins);
+          }
+          clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+          analyzerTime += getElapsedMilliseconds(&start_t, &current_t);
+        }
+
+        //the levels of the analyzers are compared in the logarithmic scale
+        getLogarithmicSpectrum(amps,amps,numFrequencyBins);
+        double maxDifference = 0;
+        if (useNoteBank) {
+          sample_t maxAmp = referenceAmps[noteBank.outputBins[0]];
+          for (int o = 0; o < noteBank.numOutputBins; o++) {
+            maxAmp = fmax(maxAmp, referenceAmps[noteBank.outputBins[o]]);
+          }
+          for (int o = 0; o < noteBank.numOutputBins; o++) {
+            int bin = noteBank.outputBins[o];
+            if (referenceAmps[bin] > maxAmp - 40) {
+              maxDifference = fmax(maxDifference, fabs(amps[bin] - referenceAmps[bin]));
+            }
+          }
+          freeNoteBank(&noteBank);
+        } else {
+          memcpy(referenceAmps, amps, numFrequencyBins*sizeof(sample_t));
+        }
+        fprintf(fp, "%s;%s;%d;%d;%d;%f;%e\n",analyzers[a],windowingFunction,sampleSize,stepSize,iterations,analyzerTime/iterations,maxDifference);
+        printf("%d/%d - %s: %fms per hop, maximal difference %fdB\n", sampleSize, stepSize, analyzers[a], analyzerTime/iterations, maxDifference);
+      }
+      freeFrameStager(&frameStager);
+      free(buff);
+    }
+    close_fft_engine(fftEngine);
+    free(outReal);
+    free(outImag);
+    free(amps);
+    free(referenceAmps);
+  }
+  fclose(fp);
+}
+
+/**
+@brief This function compares the low-note resolution and the run time of the constant q transform with the fft path.
+For every note of the six octaves that getBins searches, a tone is streamed in hops of 1024 samples for two seconds through the
+fft path (hann window, builtin engine and spectrum) of 4096 and 16384 samples and through the constant q transform with semitone
+and third-tone bins, whose bins are written to the positions of a 16384 point fft. After the last hop the loudest bin is searched with
+getFrequencyBin, a note counts as detected if the frequency of that bin (getConstantQFrequency for the constant q transform) is within
+the pitch resolution. The average time per hop in
+milliseconds and the number of detected notes are written to '../output/constantQBenchmarking.csv'.
+**/
+void constantQBenchmarking(){
+  FILE *fp;
+  fp = fopen("../output/constantQBenchmarking.csv","w");
+  fprintf(fp, "analyzer;binsPerOctave;sampleSize;fftLength;stepSize;timePerHop;numDetected;numNotes;lowestDetectedFrequency\n");
+  struct timespec start_t, current_t;
+  double rate = SAMPLE_RATE;
+  int stepSize = 1024;
+  int numHops = 2 * SAMPLE_RATE / stepSize;
+  int numNotes = 6 * 12;
+
+  char *analyzers[] = {"fft", "fft", "constant-q", "constant-q"};
+  int sampleSizes[] = {4096, 16384, 16384, 16384};
+  int binsPerOctave[] = {0, 0, 12, 36};
+  short *buff = (short *)calloc(stepSize,sizeof(short));
+  for (size_t a = 0; a < sizeof(analyzers)/sizeof(analyzers[0]); a++) {
+    int sampleSize = sampleSizes[a];
+    int numFrequencyBins = sampleSize/2 + 1;
+    int useConstantQ = strcmp(analyzers[a], "constant-q") == 0;
+    FrameStager frameStager;
+    initFrameStager(&frameStager, sampleSize, stepSize, WINDOW_HANN, runTimeInformation.kaiserBeta);
+    sample_t *outReal = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *outImag = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    sample_t *amps = (sample_t *)calloc(numFrequencyBins,sizeof(sample_t));
+    struct fft_engine *fftEngine;
+    if (!open_fft_engine(&fftEngine, "builtin", sampleSize)) {
+      fail();
+    }
+    sample_t *frame = input_fft_engine(fftEngine);
+    int fftLength = sampleSize;
+    int numDetected = 0;
+    double lowestDetectedFrequency = 0;
+    double analyzerTime = 0;
+    for (int note = 0; note < numNotes; note++) {
+      double testFrequency = runTimeInformation.tuningPitch * pow(2.0,(note-9)/12.0) * pow(2.0,-3.0);
+      ConstantQTransform constantQ;
+      if (useConstantQ) {
+        if (!initConstantQTransform(&constantQ, "builtin", sampleSize, stepSize, rate, runTimeInformation.tuningPitch, binsPerOctave[a])) {
+          fail();
+        }
+        fftLength = constantQ.kernel->fftLength;
+      }
+      resetFrameStager(&frameStager);
+      memset(amps, 0, numFrequencyBins*sizeof(sample_t));
+      for (int i = 0; i < numHops; i++) {
+        for (int n = 0; n < stepSize; n++) {
+          long sample = (long)i * stepSize + n;
+          buff[n] = (short)(8000.0 * sin(2 * M_PI * testFrequency * sample / rate));
+        }
+        clock_gettime(CLOCK_MONOTONIC_RAW,&start_t);
+        const sample_t *inputReal = stageFrame(&frameStager, buff, useConstantQ ? NULL : frame);
+        if (useConstantQ) {
+          analyzeConstantQ(&constantQ,inputReal,amps);
+        } else {
+          forward_fft_engine(fftEngine,frame,outReal,outImag);
+          getPowerSpectrum(amps,outReal,outImag,0,numFrequencyBins);
+        }
+        clock_gettime(CLOCK_MONOTONIC_RAW,&current_t);
+        analyzerTime += getElapsedMilliseconds(&start_t, &current_t);
+      }
+      int frequencyBin = getFrequencyBin(amps,sampleSize);
+      double measuredFrequency = useConstantQ ? getConstantQFrequency(&constantQ,frequencyBin) : (double)frequencyBin * rate/sampleSize;
+      if (useConstantQ) {
+        freeConstantQTransform(&constantQ);
+      }
+      double centDifference = fabs(1200 * log(measuredFrequency/testFrequency)/log(2));
+      if (centDifference < runTimeInformation.pitchResolutionInCents) {
+        numDetected++;
+        lowestDetectedFrequency = lowestDetectedFrequency == 0 ? testFrequency : lowestDetectedFrequency;
+      }
+    }
+    double timePerHop = analyzerTime/(numNotes * numHops);
+    fprintf(fp, "%s;%d;%d;%d;%d;%f;%d;%d;%f\n",analyzers[a],binsPerOctave[a],sampleSize,fftLength,stepSize,timePerHop,numDetected,numNotes,lowestDetectedFrequency);
+    printf("%s %d/%d (fft length %d): %fms per hop, %d of %d notes detected, lowest %fHz\n", analyzers[a], binsPerOctave[a], sampleSize, fftLength, timePerHop, numDetected, numNotes, lowestDetectedFrequency);
+    close_fft_engine(fftEngine);
+    freeFrameStager(&frameStager);
+    free(outReal);
+    free(outImag);
+    free(amps);
+  }
+  free(buff);
+  freeConstantQKernels();
+  fclose(fp);
+}
+
 /**
 @brief This function list all midi instruments that lilypond can use.
 The instruments are listed in the text file '../assets/instruments.txt'
@@ -2079,6 +2792,60 @@ void determineInstrument(int instrumentNumber){
   fclose(file);
 }
 
+static struct timespec cpu_start_t; ///< cpu time of the process at the start of a run of the performance benchmark
+
+/**
+@brief This function starts the clocks of one run of the performance benchmark.
+**/
+void startTimeBenchmarkingRun(){
+  wakeups = 0;
+  wakeupLatency = 0;
+  overruns = 0;
+  droppedFrames = 0;
+  droppedPeriods = 0;
+  meanLag = 0;
+  maxLag = 0;
+  spectralStageTime = 0;
+  analysisStageTime = 0;
+  trackingStageTime = 0;
+  analysisWorkers = 0;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&cpu_start_t);
+  clock_gettime(CLOCK_MONOTONIC_RAW,&whole_run_start_t);
+}
+
+/**
+@brief This function writes the times of one run of the performance benchmark to its csv file.
+Besides the times per iteration, the cpu time of all threads of the process, the idle part of one core during the run
+and the number and average latency of the wake ups of the processing thread of the threaded version are written. For the threaded
+version also its backpressure policy, how often the ring was full, the number of hops that were dropped from the ring or not analyzed
+and the mean and maximal time from the end of the capture of a hop to its note tracking. The time per hop of the staging, the frame analysis and the note tracking stage of the
+threaded version, the number of frame analysis threads and the throughput in hops per second follow. The throughput of the threaded
+version is the one of its slowest processing stage, where the frame analysis stage counts with the time of its busiest thread. The capture
+stage is not counted, its time is mostly spent waiting for the audio interface and only reflects the sample rate.
+@param fp the csv file
+@param version the version that ran, e.g. threaded
+**/
+void writeTimeBenchmarkingRow(FILE *fp, char *version){
+  struct timespec cpu_end_t;
+  clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&cpu_end_t);
+  double duration = getElapsedMilliseconds(&whole_run_start_t, &current_time_t);
+  double cpuTime = getElapsedMilliseconds(&cpu_start_t, &cpu_end_t);
+  double idleCpu = duration > 0 ? 1 - cpuTime / duration : 0;
+  int isThreaded = strcmp(version, "threaded") == 0;
+  char *policy = isThreaded ? runTimeInformation.backpressurePolicy : "";
+  double stageTime = isThreaded ? fmax(spectralStageTime, fmax(analysisStageTime, trackingStageTime)) : runTime;
+  double throughput = stageTime > 0 ? runs * 1000.0 / stageTime : 0;
+  fprintf(fp, "%s;%s;%d;%d;%f;%d;%f;%f;%f;%f;%f;%f;%f;%d;%f;%s;%d;%d;%f;%f;%f;%f;%f;%d;%f\n",version,runTimeInformation.fftEngine,runTimeInformation.stepSize,runTimeInformation.sampleSize,duration,runs,runTime/runs,audioCaptureTime/runs,fftRunTime/runs,audioPreProcessingTime/runs,audioTranscriptionTime/runs,cpuTime,idleCpu,wakeups,wakeups > 0 ? wakeupLatency/wakeups : 0,policy,overruns,droppedFrames,meanLag,maxLag,spectralStageTime/runs,analysisStageTime/runs,trackingStageTime/runs,analysisWorkers,throughput);
+  printf("%s: %fms cpu time in %fms, %f of a core idle, %d wake ups with %fms latency\n", version, cpuTime, duration, idleCpu, wakeups, wakeups > 0 ? wakeupLatency/wakeups : 0);
+  if (*policy != '\0') {
+    printf("%s policy: %d overruns, %d of %d hops dropped, lag %fms on average and %fms at most\n", policy, overruns, droppedFrames, runs + droppedPeriods, meanLag, maxLag);
+    printf("stages: capture %fms, staging %fms, frame analysis %fms on %d threads, note tracking %fms per hop, %f hops/s\n", audioCaptureTime/runs, spectralStageTime/runs, analysisStageTime/runs, analysisWorkers, trackingStageTime/runs, throughput);
+  } else if (analysisWorkers > 0) {
+    printf("%s: frame analysis on %d threads, %f hops/s\n", version, analysisWorkers, throughput);
+  }
+}
+
 /**
 @brief This function initializes runtime information values.
 **/
@@ -2090,6 +2857,15 @@ void initializeRunTimeConfiguration(){
   runTimeInformation.tuningPitch = 440.0;
   runTimeInformation.pitchResolutionInCents = 40.0;
   runTimeInformation.windowingFunction = "rectangle";
+  runTimeInformation.kaiserBeta = KAISER_BETA;
+  runTimeInformation.fftEngine = FFT_ENGINE;
+  runTimeInformation.spectralAnalyzer = SPECTRAL_ANALYZER;
+  runTimeInformation.backpressurePolicy = BACKPRESSURE_POLICY;
+  runTimeInformation.noteBankNeighbours = NOTE_BANK_NEIGHBOURS;
+  runTimeInformation.constantQBinsPerOctave = CONSTANT_Q_BINS_PER_OCTAVE;
+  runTimeInformation.peakInterpolation = PEAK_INTERPOLATION;
+  runTimeInformation.pinPipelineThreads = PIN_PIPELINE_THREADS;
+  runTimeInformation.frameAnalysisWorkers = FRAME_ANALYSIS_WORKERS;
   runTimeInformation.instrument = (char *)calloc(256, sizeof(char));
   strcpy(runTimeInformation.instrument, "trumpet");
   runTimeInformation.composer = (char *)calloc(256, sizeof(char));
@@ -2179,6 +2955,7 @@ int main(){
     printf("\t 7 - %s\n", "Chord Benchmarking");
     printf("\t 8 - %s\n", "Melody Benchmarking");
     printf("\t 9 - %s\n", "Performance Benchmarking");
+    printf("\t10 - %s\n", "Kernel Benchmarking");
     printf("%s", "Enter feature number: ");
     retError = scanf("%d", &runTimeInformation.mode);
     if (retError == -1) {
@@ -2371,49 +3148,69 @@ int main(){
         runTimeInformation.recordingTime = (float)recTime;
         printf("Recording Time: %fs\n", runTimeInformation.recordingTime);
 
+        //the fft kernels, the window generation and the peak search are measured in isolation before the sweep captures audio
+        stockhamBenchmarking();
+        windowBenchmarking();
+        peakSearchBenchmarking();
+
         char *fileName = (char *)calloc(100, sizeof(char));
         sprintf(fileName, "../output/%s.csv","timeBenchmarking");
         FILE *temp_fp;
         temp_fp = fopen(fileName, "w");
 
-        fprintf(temp_fp, "version;stepSize;sampleSize;duration;iterations;singleRunTime;audioCaptureTime;fftTime;audioPreProcessingTime;audioTranscriptionTime\n");
-        runTimeInformation.sampleSize = 128;
-        while (runTimeInformation.sampleSize <= 8192) {
-          runTimeInformation.stepSize = 16;
-          runTimeInformation.buffSize = runTimeInformation.stepSize;
-          while (runTimeInformation.stepSize <= runTimeInformation.sampleSize) {
-            printf("%d - %d\n", runTimeInformation.stepSize, runTimeInformation.sampleSize);
-            printf("Recording Time: %fs\n", runTimeInformation.recordingTime);
-            printf("%s\n\n", "############################################");
-
-            printf("%s\n", "Sequential Version:");
-            clock_gettime(CLOCK_MONOTONIC_RAW,&whole_run_start_t);
-            sequentialVersion(soundCardName);
-            clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-            fprintf(temp_fp, "%s;%d;%d;%f;%d;%f;%f;%f;%f;%f\n","sequential",runTimeInformation.stepSize,runTimeInformation.sampleSize,(current_time_t.tv_sec - whole_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - whole_run_start_t.tv_nsec)/1000000.0,runs,runTime/runs,audioCaptureTime/runs,fftRunTime/runs,audioPreProcessingTime/runs,audioTranscriptionTime/runs);
-            printf("%s\n\n", "############################################");
-
-            printf("%s\n", "Threaded Version:");
-            clock_gettime(CLOCK_MONOTONIC_RAW,&whole_run_start_t);
-            threadedRealTimeVersion(soundCardName);
-            clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-            fprintf(temp_fp, "%s;%d;%d;%f;%d;%f;%f;%f;%f;%f\n","threaded",runTimeInformation.stepSize,runTimeInformation.sampleSize,(current_time_t.tv_sec - whole_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - whole_run_start_t.tv_nsec)/1000000.0,runs,runTime/runs,audioCaptureTime/runs,fftRunTime/runs,audioPreProcessingTime/runs,audioTranscriptionTime/runs);
-            printf("%s\n\n", "############################################");
-
-            printf("%s\n", "Post Processing Version:");
-            clock_gettime(CLOCK_MONOTONIC_RAW,&whole_run_start_t);
-            writeWAVFile(soundCardName, wavFileName);
-            readWAVFile(wavFileName);
-            clock_gettime(CLOCK_MONOTONIC_RAW,&current_time_t);
-            fprintf(temp_fp, "%s;%d;%d;%f;%d;%f;%f;%f;%f;%f\n","post",runTimeInformation.stepSize,runTimeInformation.sampleSize,(current_time_t.tv_sec - whole_run_start_t.tv_sec)*1000.0+ (current_time_t.tv_nsec - whole_run_start_t.tv_nsec)/1000000.0,runs,runTime/runs,audioCaptureTime/runs,fftRunTime/runs,audioPreProcessingTime/runs,audioTranscriptionTime/runs);
-            printf("%s\n\n", "############################################");
-            runTimeInformation.stepSize *= 2;
+        fprintf(temp_fp, "version;fftEngine;stepSize;sampleSize;duration;iterations;singleRunTime;audioCaptureTime;fftTime;audioPreProcessingTime;audioTranscriptionTime;cpuTime;idleCpu;wakeups;wakeupLatency;backpressurePolicy;overruns;droppedFrames;meanLag;maxLag;spectralStageTime;analysisStageTime;trackingStageTime;analysisWorkers;throughput\n");
+        char *fftEngines[] = {"builtin", "fftw"};
+        for (size_t engine = 0; engine < sizeof(fftEngines)/sizeof(fftEngines[0]); engine++) {
+          runTimeInformation.fftEngine = fftEngines[engine];
+          runTimeInformation.sampleSize = 128;
+          while (runTimeInformation.sampleSize <= 8192) {
+            runTimeInformation.stepSize = 16;
+            runTimeInformation.buffSize = runTimeInformation.stepSize;
+            while (runTimeInformation.stepSize <= runTimeInformation.sampleSize) {
+              printf("%s: %d - %d\n", runTimeInformation.fftEngine, runTimeInformation.stepSize, runTimeInformation.sampleSize);
+              printf("Recording Time: %fs\n", runTimeInformation.recordingTime);
+              printf("%s\n\n", "############################################");
+
+              printf("%s\n", "Sequential Version:");
+              startTimeBenchmarkingRun();
+              sequentialVersion(soundCardName);
+              writeTimeBenchmarkingRow(temp_fp, "sequential");
+              printf("%s\n\n", "############################################");
+
+              char *backpressurePolicies[] = {"block", "drop-oldest", "degrade"};
+              for (size_t policy = 0; policy < sizeof(backpressurePolicies)/sizeof(backpressurePolicies[0]); policy++) {
+                printf("Threaded Version (%s):\n", backpressurePolicies[policy]);
+                runTimeInformation.backpressurePolicy = backpressurePolicies[policy];
+                startTimeBenchmarkingRun();
+                threadedRealTimeVersion(soundCardName);
+                writeTimeBenchmarkingRow(temp_fp, "threaded");
+                printf("%s\n\n", "############################################");
+              }
+              runTimeInformation.backpressurePolicy = BACKPRESSURE_POLICY;
+
+              printf("%s\n", "Post Processing Version:");
+              startTimeBenchmarkingRun();
+              writeWAVFile(soundCardName, wavFileName);
+              readWAVFile(wavFileName);
+              writeTimeBenchmarkingRow(temp_fp, "post");
+              printf("%s\n\n", "############################################");
+              runTimeInformation.stepSize *= 2;
+            }
+            runTimeInformation.sampleSize *= 2;
           }
-          runTimeInformation.sampleSize *= 2;
         }
+        runTimeInformation.fftEngine = FFT_ENGINE;
         fclose(temp_fp);
         runTimeInformation.timeBenchmarking = 0;
         break;
+      case 10:
+        printf("%s\n", "Kernel Benchmarking Mode");
+        kernelBenchmarking();
+        noteAccuracyBenchmarking();
+        noteLatencyBenchmarking();
+        noteBankBenchmarking();
+        constantQBenchmarking();
+        break;
       default:
         printf("%s\n", "Mode does not exist!");
         break;
@@ -2423,5 +3220,7 @@ int main(){
     free(runTimeInformation.composer);
     free(runTimeInformation.instrument);
     free(soundCardName);
+    freeWindowCoefficients();
+    freeNoteTables();
     return 0;
 }